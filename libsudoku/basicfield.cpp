@@ -0,0 +1,262 @@
+#include "basicfield.h"
+#include "canceltoken.h"
+#include "field.h"
+
+#include <bit>
+
+template<quint8 BoxSize>
+constexpr typename BasicField<BoxSize>::Tables BasicField<BoxSize>::makeTables( )
+{
+    Tables t {};
+    for ( quint8 i = 0; i < N; i++ ) {
+        for ( quint8 j = 0; j < N; j++ ) {
+            t.houses[i][j]     = i * N + j;
+            t.houses[N + i][j] = j * N + i;
+            const quint8 row   = (i / BoxSize) * BoxSize + j / BoxSize;
+            const quint8 col   = (i % BoxSize) * BoxSize + j % BoxSize;
+            t.houses[2 * N + i][j] = row * N + col;
+        }
+    }
+    for ( quint16 idx = 0; idx < CellsCount; idx++ ) {
+        const quint8 row = idx / N;
+        const quint8 col = idx % N;
+        quint8       cnt = 0;
+        for ( quint8 k = 0; k < N; k++ ) {
+            if ( k != col )
+                t.peers[idx][cnt++] = row * N + k;
+            if ( k != row )
+                t.peers[idx][cnt++] = k * N + col;
+        }
+        // square cells outside of own row and column
+        const quint8 r0 = row - row % BoxSize;
+        const quint8 c0 = col - col % BoxSize;
+        for ( quint8 r = r0; r < r0 + BoxSize; r++ )
+            for ( quint8 c = c0; c < c0 + BoxSize; c++ )
+                if ( r != row && c != col )
+                    t.peers[idx][cnt++] = r * N + c;
+    }
+    return t;
+}
+
+template<quint8 BoxSize>
+constinit const typename BasicField<BoxSize>::Tables BasicField<BoxSize>::tables = BasicField<BoxSize>::makeTables( );
+
+template<quint8 BoxSize>
+void BasicField<BoxSize>::clear( )
+{
+    candidates.fill(AllCandidates);
+    values.fill(0);
+    unresolved = CellsCount;
+}
+
+template<quint8 BoxSize>
+bool BasicField<BoxSize>::assign(quint16 idx, CellValue val)
+{
+    const Mask bit = static_cast<Mask>(Mask {1} << (val - 1));
+    if ( values[idx] )
+        return values[idx] == val;
+    if ( !(candidates[idx] & bit) )
+        return false;
+    values[idx]     = val;
+    candidates[idx] = bit;
+    unresolved--;
+    bool ok = true;
+    for ( quint16 peer: tables.peers[idx] ) {
+        if ( values[peer] )
+            continue;
+        candidates[peer] &= ~bit;
+        ok &= candidates[peer] != 0;
+    }
+    return ok;
+}
+
+template<quint8 BoxSize>
+bool BasicField<BoxSize>::parse(QStringView line)
+{
+    clear( );
+    if ( line.length( ) < CellsCount )
+        return false;
+    for ( quint16 idx = 0; idx < CellsCount; idx++ ) {
+        const CellValue v = Field::symbolValue(line[idx]);
+        if ( v > N )
+            return false;
+        if ( v && !assign(idx, v) )
+            return false;
+    }
+    return true;
+}
+
+template<quint8 BoxSize>
+void BasicField<BoxSize>::load(const Field& field)
+{
+    unresolved = 0;
+    for ( quint16 idx = 0; idx < CellsCount; idx++ ) {
+        Cell::CPtr pCell = field.cellAt(idx);
+        values[idx]      = pCell->value( );
+        candidates[idx]  = static_cast<Mask>(pCell->candidatesMask( ).raw( ));
+        if ( !values[idx] )
+            unresolved++;
+    }
+}
+
+template<quint8 BoxSize>
+void BasicField<BoxSize>::assignTo(Field& field) const
+{
+    for ( quint16 idx = 0; idx < CellsCount; idx++ )
+        field.cellAt(idx)->assignState(values[idx], CandidateMask::fromRaw(candidates[idx]), values[idx] != 0);
+}
+
+template<quint8 BoxSize>
+int BasicField<BoxSize>::store(Field& field) const
+{
+    int changed = 0;
+    for ( quint16 idx = 0; idx < CellsCount; idx++ ) {
+        Cell::Ptr pCell = field.cellAt(idx);
+        if ( pCell->isResolved( ) )
+            continue;
+        if ( values[idx] ) {
+            pCell->setValue(values[idx]);
+            changed++;
+        } else if ( pCell->removeCandidate(~CandidateMask::fromRaw(candidates[idx])) )
+            changed++;
+    }
+    return changed;
+}
+
+template<quint8 BoxSize>
+bool BasicField<BoxSize>::propagateSingles( )
+{
+    bool progress = true;
+    while ( progress && unresolved ) {
+        progress = false;
+        for ( quint16 idx = 0; idx < CellsCount; idx++ ) {
+            if ( values[idx] )
+                continue;
+            const Mask m = candidates[idx];
+            if ( !m )
+                return false;
+            if ( std::has_single_bit(m) ) {
+                if ( !assign(idx, static_cast<CellValue>(std::countr_zero(m) + 1)) )
+                    return false;
+                progress = true;
+            }
+        }
+        for ( const auto& house: tables.houses ) {
+            Mask atLeastOnce  = 0;
+            Mask moreThanOnce = 0;
+            Mask placed       = 0;
+            for ( quint16 idx: house ) {
+                const Mask m = candidates[idx];
+                moreThanOnce |= atLeastOnce & m;
+                atLeastOnce |= m;
+                if ( values[idx] )
+                    placed |= m;
+            }
+            if ( atLeastOnce != AllCandidates )
+                return false;
+            Mask hidden = atLeastOnce & ~moreThanOnce & ~placed;
+            for ( ; hidden; hidden &= hidden - 1 ) {
+                const CellValue v   = static_cast<CellValue>(std::countr_zero(hidden) + 1);
+                const Mask      bit = static_cast<Mask>(Mask {1} << (v - 1));
+                for ( quint16 idx: house ) {
+                    if ( candidates[idx] & bit ) {
+                        if ( !assign(idx, v) )
+                            return false;
+                        break;
+                    }
+                }
+                progress = true;
+            }
+        }
+    }
+    return true;
+}
+
+template<quint8 BoxSize>
+bool BasicField<BoxSize>::search(quint64& nodes, const CancelToken* cancel)
+{
+    BasicField root = *this;
+    if ( !root.branch(nodes, cancel) )
+        return false;
+    *this = root;
+    return true;
+}
+
+template<quint8 BoxSize>
+quint16 BasicField<BoxSize>::branchCell( ) const
+{
+    quint16 branchIdx = CellsCount;
+    int     fewest    = N + 1;
+    for ( quint16 idx = 0; idx < CellsCount && fewest > 2; idx++ ) {
+        if ( values[idx] )
+            continue;
+        const int count = std::popcount(candidates[idx]);
+        if ( count < fewest ) {
+            fewest    = count;
+            branchIdx = idx;
+        }
+    }
+    return branchIdx;
+}
+
+template<quint8 BoxSize>
+bool BasicField<BoxSize>::branch(quint64& nodes, const CancelToken* cancel)
+{
+    nodes++;
+    if ( cancel && cancel->isCancelled( ) )
+        return false;
+    if ( !propagateSingles( ) )
+        return false;
+    if ( isResolved( ) )
+        return true;
+
+    const quint16 branchIdx = branchCell( );
+    for ( Mask m = candidates[branchIdx]; m; m &= m - 1 ) {
+        BasicField child = *this;
+        if ( child.assign(branchIdx, static_cast<CellValue>(std::countr_zero(m) + 1)) && child.branch(nodes, cancel) ) {
+            *this = child;
+            return true;
+        }
+    }
+    return false;
+}
+
+template<quint8 BoxSize>
+void BasicField<BoxSize>::count(Counting& counting)
+{
+    // reading the clock on every node would cost more than the node itself
+    constexpr quint64 DeadlineCheckNodes = 256;
+
+    if ( counting.expired || counting.solutions >= counting.limit )
+        return;
+    if ( ++counting.nodes % DeadlineCheckNodes == 0 && counting.deadline.hasExpired( ) ) {
+        counting.expired = true;
+        return;
+    }
+    if ( !propagateSingles( ) )
+        return;
+    if ( isResolved( ) ) {
+        counting.solutions++;
+        return;
+    }
+
+    const quint16 branchIdx = branchCell( );
+    for ( Mask m = candidates[branchIdx]; m && counting.solutions < counting.limit && !counting.expired; m &= m - 1 ) {
+        BasicField child = *this;
+        if ( child.assign(branchIdx, static_cast<CellValue>(std::countr_zero(m) + 1)) )
+            child.count(counting);
+    }
+}
+
+template<quint8 BoxSize>
+SolutionCount BasicField<BoxSize>::countSolutions(quint64 limit, QDeadlineTimer deadline) const
+{
+    Counting   counting {limit, deadline};
+    BasicField root = *this;
+    root.count(counting);
+    return {counting.solutions, counting.nodes, counting.expired};
+}
+
+template class BasicField<3>;
+template class BasicField<4>;
+template class BasicField<5>;
@@ -0,0 +1,159 @@
+#ifndef BASICFIELD_H
+#define BASICFIELD_H
+
+#include "candidatemask.h"
+
+#include <QDeadlineTimer>
+#include <QStringView>
+
+#include <array>
+#include <type_traits>
+
+class CancelToken;
+class Field;
+
+/*! \brief outcome of a solution count, see BasicField::countSolutions() */
+struct SolutionCount
+{
+    quint64 solutions {0};    ///< solutions found, at most the requested limit
+    quint64 nodes {0};        ///< search nodes visited
+    bool    timedOut {false}; ///< deadline expired before the search was complete
+
+    bool isUnique( ) const { return solutions == 1 && !timedOut; }
+};
+
+/*! \brief Compile-time sized solving core for boards with BoxSize x BoxSize squares
+ *
+ * N, the house and peer tables and the mask width are constants, so loops over a
+ * house have a fixed trip count and a cell mask is one 16- or 32-bit register.
+ * It knows only givens propagation, singles and backtracking search; Field remains
+ * the place where all other techniques run. Use withBasicField() to pick the instantiation at runtime.
+ */
+template<quint8 BoxSize>
+class BasicField
+{
+public:
+    static constexpr quint8  N          = BoxSize * BoxSize;
+    static constexpr quint16 CellsCount = N * N;
+    static constexpr quint8  PeersCount = 3 * N - 2 * BoxSize - 1;
+    static constexpr quint8  HousesCount = 3 * N;
+
+    using Mask = std::conditional_t<(N <= 16), quint16, quint32>;
+
+    static constexpr Mask AllCandidates = static_cast<Mask>((quint64 {1} << N) - 1);
+
+    struct Tables
+    {
+        std::array<std::array<quint16, N>, HousesCount>         houses;  // rows, columns, squares
+        std::array<std::array<quint16, PeersCount>, CellsCount> peers;
+    };
+
+    static const Tables tables;
+
+private:
+    std::array<Mask, CellsCount>      candidates;
+    std::array<CellValue, CellsCount> values;
+    quint16                           unresolved {CellsCount};
+
+    static constexpr Tables makeTables( );
+
+    struct Counting
+    {
+        quint64        limit;
+        QDeadlineTimer deadline;
+        quint64        solutions {0};
+        quint64        nodes {0};
+        bool           expired {false};
+    };
+
+    /// unresolved cell with the fewest candidates, stops early at a bivalue one
+    quint16 branchCell( ) const;
+    /// search() step working in place; the state is garbage if it returns false
+    bool branch(quint64& nodes, const CancelToken* cancel);
+    /// countSolutions() step working in place
+    void count(Counting& counting);
+
+public:
+    BasicField( ) { clear( ); }
+
+    void clear( );
+
+    /*! \brief places \a val into cell \a idx and removes it from all peers
+     * \return false if \a val is not a candidate there or a peer runs out of candidates
+     */
+    bool assign(quint16 idx, CellValue val);
+
+    /*! \brief reads a plain text puzzle line, propagating givens only
+     * \return false on a wrong symbol or contradicting givens
+     */
+    bool parse(QStringView line);
+
+    /*! \brief copies values and candidates of \a field, which must have N == BasicField::N */
+    void load(const Field& field);
+
+    /*! \brief overwrites a freshly reset \a field with this state, without propagation */
+    void assignTo(Field& field) const;
+
+    /*! \brief applies the difference to \a field through regular setValue/removeCandidate
+     * \return number of cells changed
+     */
+    int store(Field& field) const;
+
+    /*! \brief naked and hidden singles until nothing changes
+     * \return false on contradiction
+     */
+    bool propagateSingles( );
+
+    /*! \brief depth-first search for a solution, completing this state in place
+     *
+     * Every node propagates singles, then branches on the unresolved cell with the
+     * fewest candidates. A branch works on a copy of the state, so backtracking is
+     * just dropping that copy. \a nodes is increased by the number of visited nodes.
+     * The search gives up once \a cancel, if any, is cancelled.
+     * \return false if there is no solution or the search gave up; the state is left unchanged then
+     */
+    bool search(quint64& nodes, const CancelToken* cancel = nullptr);
+
+    /*! \brief counts solutions by the same search, stopping once \a limit are found
+     *
+     * Two is enough to tell a unique puzzle from an ambiguous one. The \a deadline
+     * is checked every few hundred nodes; the count is a lower bound if it expires.
+     */
+    SolutionCount countSolutions(quint64 limit = 2, QDeadlineTimer deadline = QDeadlineTimer::Forever) const;
+
+    bool isResolved( ) const { return unresolved == 0; }
+
+    CellValue value(quint16 idx) const { return values[idx]; }
+
+    Mask candidatesMask(quint16 idx) const { return candidates[idx]; }
+};
+
+extern template class BasicField<3>;
+extern template class BasicField<4>;
+extern template class BasicField<5>;
+
+/*! \brief calls \a f with a BasicField instantiation for board size \a n
+ * \return result of \a f, or false if there is no instantiation for \a n
+ */
+template<class F>
+bool withBasicField(quint8 n, F&& f)
+{
+    switch ( n ) {
+        case BasicField<3>::N: {
+            BasicField<3> engine;
+            return f(engine);
+        }
+        case BasicField<4>::N: {
+            BasicField<4> engine;
+            return f(engine);
+        }
+        case BasicField<5>::N: {
+            BasicField<5> engine;
+            return f(engine);
+        }
+        default:
+            return false;
+    }
+}
+
+#endif  // BASICFIELD_H
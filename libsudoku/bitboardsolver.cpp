@@ -0,0 +1,325 @@
+#include "bitboardsolver.h"
+#include "field.h"
+
+#include <bit>
+
+#if defined(__SSE2__) && !defined(SUDOKU_NO_SIMD)
+#include <immintrin.h>
+#define BITBOARD_SSE
+#endif
+
+namespace {
+
+constexpr quint32 BandMask = (quint32 {1} << 27) - 1;
+
+using Bands = BitboardSolver::Bands;
+
+#ifdef BITBOARD_SSE
+using Vec = __m128i;
+
+inline Vec loadBands(const Bands& b) { return _mm_load_si128(reinterpret_cast<const __m128i*>(b.lanes)); }
+
+inline void storeBands(Bands& b, Vec v) { _mm_store_si128(reinterpret_cast<__m128i*>(b.lanes), v); }
+
+inline Vec zero( ) { return _mm_setzero_si128( ); }
+
+inline Vec bitAnd(Vec a, Vec b) { return _mm_and_si128(a, b); }
+
+inline Vec bitOr(Vec a, Vec b) { return _mm_or_si128(a, b); }
+
+/// \a b without bits of \a a
+inline Vec andNot(Vec a, Vec b) { return _mm_andnot_si128(a, b); }
+
+inline bool isZero(Vec a)
+{
+#ifdef __SSE4_1__
+    return _mm_testz_si128(a, a);
+#else
+    return _mm_movemask_epi8(_mm_cmpeq_epi32(a, _mm_setzero_si128( ))) == 0xFFFF;
+#endif
+}
+#else
+struct Vec
+{
+    quint32 lanes[4];
+};
+
+inline Vec loadBands(const Bands& b) { return {b.lanes[0], b.lanes[1], b.lanes[2], b.lanes[3]}; }
+
+inline void storeBands(Bands& b, Vec v)
+{
+    for ( int k = 0; k < 4; k++ )
+        b.lanes[k] = v.lanes[k];
+}
+
+inline Vec zero( ) { return {0, 0, 0, 0}; }
+
+inline Vec bitAnd(Vec a, Vec b) { return {a.lanes[0] & b.lanes[0], a.lanes[1] & b.lanes[1], a.lanes[2] & b.lanes[2], a.lanes[3] & b.lanes[3]}; }
+
+inline Vec bitOr(Vec a, Vec b) { return {a.lanes[0] | b.lanes[0], a.lanes[1] | b.lanes[1], a.lanes[2] | b.lanes[2], a.lanes[3] | b.lanes[3]}; }
+
+/// \a b without bits of \a a
+inline Vec andNot(Vec a, Vec b) { return {~a.lanes[0] & b.lanes[0], ~a.lanes[1] & b.lanes[1], ~a.lanes[2] & b.lanes[2], ~a.lanes[3] & b.lanes[3]}; }
+
+inline bool isZero(Vec a) { return (a.lanes[0] | a.lanes[1] | a.lanes[2] | a.lanes[3]) == 0; }
+#endif
+
+/// std::has_single_bit() is a popcount, which is a library call without -mpopcnt
+inline bool isSingleBit(quint32 m) { return m && !(m & (m - 1)); }
+
+/// first cell of \a b, which must not be empty
+inline quint8 firstCell(const Bands& b)
+{
+    for ( quint8 k = 0; ; k++ )
+        if ( b.lanes[k] )
+            return static_cast<quint8>(k * 27 + std::countr_zero(b.lanes[k]));
+}
+
+}  // namespace
+
+constexpr BitboardSolver::Tables BitboardSolver::makeTables( )
+{
+    Tables t {};
+    for ( quint8 i = 0; i < CellsCount; i++ )
+        t.cell[i].lanes[i / 27] = quint32 {1} << (i % 27);
+    for ( quint8 i = 0; i < CellsCount; i++ ) {
+        for ( quint8 j = 0; j < CellsCount; j++ ) {
+            const bool sameRow    = i / N == j / N;
+            const bool sameColumn = i % N == j % N;
+            const bool sameSquare = i / 27 == j / 27 && (i % N) / 3 == (j % N) / 3;
+            if ( i != j && (sameRow || sameColumn || sameSquare) )
+                t.peers[i].lanes[j / 27] |= quint32 {1} << (j % 27);
+        }
+    }
+    t.all = {{BandMask, BandMask, BandMask, 0}};
+    return t;
+}
+
+constinit const BitboardSolver::Tables BitboardSolver::tables = BitboardSolver::makeTables( );
+
+void BitboardSolver::clear( )
+{
+    candidates.fill(tables.all);
+    solved = {{0, 0, 0, 0}};
+}
+
+bool BitboardSolver::place(quint8 cell, quint8 digit)
+{
+    const Vec bit = loadBands(tables.cell[cell]);
+    if ( isZero(bitAnd(bit, loadBands(candidates[digit]))) )
+        return false;
+    for ( Bands& digitCells: candidates )
+        storeBands(digitCells, andNot(bit, loadBands(digitCells)));
+    storeBands(candidates[digit], bitOr(andNot(loadBands(tables.peers[cell]), loadBands(candidates[digit])), bit));
+    storeBands(solved, bitOr(loadBands(solved), bit));
+    return true;
+}
+
+int BitboardSolver::digitAt(quint8 cell) const
+{
+    const quint8  lane = cell / 27;
+    const quint32 bit  = quint32 {1} << (cell % 27);
+    for ( quint8 d = 0; d < N; d++ )
+        if ( candidates[d].lanes[lane] & bit )
+            return d;
+    return -1;
+}
+
+bool BitboardSolver::propagate( )
+{
+    for ( ;; ) {
+        Vec atLeastOnce  = zero( );
+        Vec moreThanOnce = zero( );
+        for ( const Bands& digitCells: candidates ) {
+            const Vec c  = loadBands(digitCells);
+            moreThanOnce = bitOr(moreThanOnce, bitAnd(atLeastOnce, c));
+            atLeastOnce  = bitOr(atLeastOnce, c);
+        }
+        if ( !isZero(andNot(atLeastOnce, loadBands(tables.all))) )
+            return false;
+
+        Bands singles;
+        storeBands(singles, andNot(bitOr(moreThanOnce, loadBands(solved)), atLeastOnce));
+        if ( !isZero(loadBands(singles)) ) {
+            for ( quint8 k = 0; k < 3; k++ ) {
+                for ( quint32 m = singles.lanes[k]; m; m &= m - 1 ) {
+                    const quint8 cell  = static_cast<quint8>(k * 27 + std::countr_zero(m));
+                    const int    digit = digitAt(cell);
+                    if ( digit < 0 || !place(cell, static_cast<quint8>(digit)) )
+                        return false;
+                }
+            }
+            continue;
+        }
+
+        const int hidden = hiddenSingles( );
+        if ( hidden <= 0 )
+            return hidden == 0;
+    }
+}
+
+int BitboardSolver::hiddenSingles( )
+{
+    // rows and squares lie inside one band, columns take a bit from each band
+    constexpr quint32 RowMask    = 0x1FF;
+    constexpr quint32 SquareMask = 0x7 | (0x7 << 9) | (0x7 << 18);
+    constexpr quint32 ColumnMask = 0x1 | (0x1 << 9) | (0x1 << 18);
+    int               placed     = 0;
+
+    auto placeSingle = [this, &placed] (quint8 lane, quint32 m, quint8 digit) {
+        if ( solved.lanes[lane] & m )
+            return true;
+        placed++;
+        return place(static_cast<quint8>(lane * 27 + std::countr_zero(m)), digit);
+    };
+
+    for ( quint8 d = 0; d < N; d++ ) {
+        // digit left only in solved cells: done if placed in every row, dead otherwise
+        if ( isZero(andNot(loadBands(solved), loadBands(candidates[d]))) ) {
+            const Bands& placedCells = candidates[d];
+            if ( std::popcount(placedCells.lanes[0]) + std::popcount(placedCells.lanes[1]) + std::popcount(placedCells.lanes[2]) != N )
+                return -1;
+            continue;
+        }
+        for ( quint8 k = 0; k < 3; k++ ) {
+            for ( quint8 i = 0; i < 3; i++ ) {
+                const quint32 row = candidates[d].lanes[k] & (RowMask << (9 * i));
+                if ( !row || (isSingleBit(row) && !placeSingle(k, row, d)) )
+                    return -1;
+                const quint32 square = candidates[d].lanes[k] & (SquareMask << (3 * i));
+                if ( !square || (isSingleBit(square) && !placeSingle(k, square, d)) )
+                    return -1;
+            }
+        }
+        for ( quint8 c = 0; c < N; c++ ) {
+            const quint32 column[3] = {candidates[d].lanes[0] & (ColumnMask << c),
+                                       candidates[d].lanes[1] & (ColumnMask << c),
+                                       candidates[d].lanes[2] & (ColumnMask << c)};
+            const quint32 any       = column[0] | column[1] | column[2];
+            if ( !any )
+                return -1;
+            // single bit overall: one band has it and the others are empty
+            if ( isSingleBit(any) && (column[0] == any) + (column[1] == any) + (column[2] == any) == 1 ) {
+                const quint8 k = column[0] ? 0 : column[1] ? 1 : 2;
+                if ( !placeSingle(k, column[k], d) )
+                    return -1;
+            }
+        }
+    }
+    return placed;
+}
+
+bool BitboardSolver::branch(quint64& nodes)
+{
+    nodes++;
+    if ( !propagate( ) )
+        return false;
+    const Vec unsolved = andNot(loadBands(solved), loadBands(tables.all));
+    if ( isZero(unsolved) )
+        return true;
+
+    Vec atLeastOnce  = zero( );
+    Vec twiceOrMore  = zero( );
+    Vec thriceOrMore = zero( );
+    for ( const Bands& digitCells: candidates ) {
+        const Vec c  = loadBands(digitCells);
+        thriceOrMore = bitOr(thriceOrMore, bitAnd(twiceOrMore, c));
+        twiceOrMore  = bitOr(twiceOrMore, bitAnd(atLeastOnce, c));
+        atLeastOnce  = bitOr(atLeastOnce, c);
+    }
+    const Vec bivalue = bitAnd(andNot(thriceOrMore, twiceOrMore), unsolved);
+
+    Bands pick;
+    storeBands(pick, isZero(bivalue) ? unsolved : bivalue);
+    const quint8 cell = firstCell(pick);
+    const Vec    bit  = loadBands(tables.cell[cell]);
+    for ( quint8 d = 0; d < N; d++ ) {
+        if ( isZero(bitAnd(bit, loadBands(candidates[d]))) )
+            continue;
+        BitboardSolver child = *this;
+        if ( child.place(cell, d) && child.branch(nodes) ) {
+            *this = child;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BitboardSolver::solve(quint64& nodes)
+{
+    BitboardSolver root = *this;
+    if ( !root.branch(nodes) )
+        return false;
+    *this = root;
+    return true;
+}
+
+bool BitboardSolver::parse(QStringView line)
+{
+    clear( );
+    if ( line.length( ) < CellsCount )
+        return false;
+    for ( quint8 idx = 0; idx < CellsCount; idx++ ) {
+        const CellValue v = Field::symbolValue(line[idx]);
+        if ( v > N )
+            return false;
+        if ( v && !place(idx, v - 1) )
+            return false;
+    }
+    return true;
+}
+
+bool BitboardSolver::load(const Field& field)
+{
+    clear( );
+    if ( field.getN( ) != N )
+        return false;
+    for ( quint8 idx = 0; idx < CellsCount; idx++ ) {
+        Cell::CPtr pCell = field.cellAt(idx);
+        if ( pCell->isResolved( ) )
+            continue;
+        for ( quint8 d = 0; d < N; d++ )
+            if ( !pCell->hasCandidate(d + 1) )
+                storeBands(candidates[d], andNot(loadBands(tables.cell[idx]), loadBands(candidates[d])));
+    }
+    for ( quint8 idx = 0; idx < CellsCount; idx++ ) {
+        Cell::CPtr pCell = field.cellAt(idx);
+        if ( pCell->isResolved( ) && !place(idx, pCell->value( ) - 1) )
+            return false;
+    }
+    return true;
+}
+
+int BitboardSolver::store(Field& field) const
+{
+    int changed = 0;
+    for ( quint8 idx = 0; idx < CellsCount; idx++ ) {
+        Cell::Ptr pCell = field.cellAt(idx);
+        if ( pCell->isResolved( ) )
+            continue;
+        if ( const CellValue v = value(idx) ) {
+            pCell->setValue(v);
+            changed++;
+            continue;
+        }
+        CandidateMask left;
+        for ( quint8 d = 0; d < N; d++ )
+            if ( tables.cell[idx].lanes[idx / 27] & candidates[d].lanes[idx / 27] )
+                left.setCandidate(d + 1);
+        if ( pCell->removeCandidate(~left) )
+            changed++;
+    }
+    return changed;
+}
+
+bool BitboardSolver::isResolved( ) const
+{
+    return isZero(andNot(loadBands(solved), loadBands(tables.all)));
+}
+
+CellValue BitboardSolver::value(quint8 idx) const
+{
+    if ( !(solved.lanes[idx / 27] & (quint32 {1} << (idx % 27))) )
+        return 0;
+    return static_cast<CellValue>(digitAt(idx) + 1);
+}
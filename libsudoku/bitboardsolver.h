@@ -0,0 +1,88 @@
+#ifndef BITBOARDSOLVER_H
+#define BITBOARDSOLVER_H
+
+#include "candidatemask.h"
+
+#include <QStringView>
+
+#include <array>
+
+class Field;
+
+/*! \brief Brute-force 9x9 solver on band bitboards, built for puzzles per second
+ *
+ * Each digit keeps the cells it may still go to as three 27-bit bands (rows 0-2,
+ * 3-5, 6-8) in one 128-bit value, so a placement is a handful of vector and/andnot
+ * operations and naked singles are found for all 81 cells at once. Vector code uses
+ * SSE2 where the compiler targets it; define SUDOKU_NO_SIMD to get the scalar
+ * fallback. It explains nothing: use Resolver for human-style steps.
+ */
+class BitboardSolver
+{
+public:
+    static constexpr quint8  N          = 9;
+    static constexpr quint16 CellsCount = N * N;
+
+    /// one bit per cell: band k holds cells 27k..27k+26, last lane is always 0
+    struct alignas(16) Bands
+    {
+        quint32 lanes[4];
+    };
+
+    struct Tables
+    {
+        std::array<Bands, CellsCount> cell;
+        std::array<Bands, CellsCount> peers;
+        Bands                         all;
+    };
+
+    static const Tables tables;
+
+private:
+    std::array<Bands, N> candidates;  // by digit, a placed digit keeps its own cell
+    Bands                solved;
+
+    static constexpr Tables makeTables( );
+
+    bool place(quint8 cell, quint8 digit);
+    int  digitAt(quint8 cell) const;
+    bool propagate( );
+    int  hiddenSingles( );
+    /// solve() step working in place; the state is garbage if it returns false
+    bool branch(quint64& nodes);
+
+public:
+    BitboardSolver( ) { clear( ); }
+
+    void clear( );
+
+    /*! \brief reads a plain text puzzle line, applying givens only
+     * \return false on a wrong symbol or contradicting givens
+     */
+    bool parse(QStringView line);
+
+    /*! \brief copies values and candidates of \a field
+     * \return false if \a field is not 9x9 or its values contradict each other
+     */
+    bool load(const Field& field);
+
+    /*! \brief applies the difference to \a field through regular setValue/removeCandidate
+     * \return number of cells changed
+     */
+    int store(Field& field) const;
+
+    /*! \brief singles propagation and guessing until the board is complete
+     *
+     * Guesses go to a cell with two candidates when there is one. \a nodes is
+     * increased by the number of visited nodes.
+     * \return false if there is no solution; the state is left unchanged then
+     */
+    bool solve(quint64& nodes);
+
+    bool isResolved( ) const;
+
+    /*! \brief placed value of cell \a idx, 0 if it is not placed yet */
+    CellValue value(quint8 idx) const;
+};
+
+#endif  // BITBOARDSOLVER_H
@@ -0,0 +1,58 @@
+#ifndef CANCELTOKEN_H
+#define CANCELTOKEN_H
+
+#include <QDeadlineTimer>
+
+#include <atomic>
+
+/*! \brief cooperative stop request for a solve: an explicit cancel() or an expired deadline
+ *
+ * Long loops may call isCancelled() as often as they like: it is one relaxed load, and
+ * only every CheckInterval-th call of a thread reads the clock. Once seen, an expired
+ * deadline stays latched until the next setDeadline(). cancel() is safe from any thread.
+ */
+class CancelToken
+{
+public:
+    static constexpr quint32 CheckInterval = 64;
+
+    /*! \brief arms \a deadline and forgets an expiry seen before; a cancel() request stays */
+    void setDeadline(QDeadlineTimer deadline)
+    {
+        this->deadline = deadline;
+        expired.store(false, std::memory_order_relaxed);
+    }
+    /// asks the current or next solve to stop
+    void cancel( ) { cancelled.store(true, std::memory_order_relaxed); }
+    /// withdraws a cancel() request
+    void clear( ) { cancelled.store(false, std::memory_order_relaxed); }
+
+    /// cheap check for inner loops, sees the deadline with a delay of up to CheckInterval calls
+    bool isCancelled( ) const
+    {
+        if ( cancelled.load(std::memory_order_relaxed) || expired.load(std::memory_order_relaxed) )
+            return true;
+        return ++polls % CheckInterval == 0 && checkDeadline( );
+    }
+    /// exact check, reads the clock every time
+    bool checkNow( ) const { return cancelled.load(std::memory_order_relaxed) || checkDeadline( ); }
+    /// whether a cancel() is pending or a check has seen the deadline expire, without reading the clock
+    bool wasCancelled( ) const { return cancelled.load(std::memory_order_relaxed) || expired.load(std::memory_order_relaxed); }
+
+private:
+    bool checkDeadline( ) const
+    {
+        if ( !deadline.hasExpired( ) )
+            return false;
+        expired.store(true, std::memory_order_relaxed);
+        return true;
+    }
+
+    QDeadlineTimer            deadline {QDeadlineTimer::Forever};
+    std::atomic<bool>         cancelled {false};
+    mutable std::atomic<bool> expired {false};
+
+    static inline thread_local quint32 polls {0};
+};
+
+#endif  // CANCELTOKEN_H
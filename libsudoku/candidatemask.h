@@ -0,0 +1,161 @@
+#ifndef CANDIDATEMASK_H
+#define CANDIDATEMASK_H
+
+#include <QtCore/qglobal.h>
+
+#include <bit>
+#include <iostream>
+
+using CellValue = quint8;
+
+/*! \brief Set of candidate values of a cell packed into one machine word
+ *
+ * Bit (v-1) stands for candidate v, so any puzzle with N <= 64 fits. The mask
+ * does not know its capacity: complement (~) sets the unused high bits too, which
+ * is harmless as long as the result is combined with a real cell mask.
+ */
+class CandidateMask
+{
+    quint64 bits {0};
+
+    constexpr explicit CandidateMask(quint64 raw) : bits(raw) {}
+
+public:
+    class const_iterator
+    {
+        quint64 rest;
+
+    public:
+        constexpr explicit const_iterator(quint64 bits) : rest(bits) {}
+
+        constexpr CellValue operator* ( ) const { return static_cast<CellValue>(std::countr_zero(rest) + 1); }
+
+        constexpr const_iterator& operator++ ( )
+        {
+            rest &= rest - 1;
+            return *this;
+        }
+
+        constexpr bool operator!= (const const_iterator& o) const { return rest != o.rest; }
+
+        constexpr bool operator== (const const_iterator& o) const { return rest == o.rest; }
+    };
+
+    constexpr CandidateMask( ) = default;
+
+    static constexpr CandidateMask fromRaw(quint64 raw) { return CandidateMask(raw); }
+
+    static constexpr CandidateMask all(quint8 n) { return CandidateMask(n >= 64 ? ~0ULL : (1ULL << n) - 1); }
+
+    static constexpr CandidateMask single(CellValue val) { return CandidateMask(1ULL << (val - 1)); }
+
+    constexpr quint64 raw( ) const { return bits; }
+
+    constexpr bool hasCandidate(CellValue val) const { return bits & (1ULL << (val - 1)); }
+
+    constexpr void setCandidate(CellValue val) { bits |= 1ULL << (val - 1); }
+
+    constexpr void clearCandidate(CellValue val) { bits &= ~(1ULL << (val - 1)); }
+
+    constexpr int count( ) const { return std::popcount(bits); }
+
+    constexpr bool isEmpty( ) const { return bits == 0; }
+
+    constexpr bool isSingle( ) const { return std::has_single_bit(bits); }
+
+    /*! \brief lowest candidate in the mask, 0 for empty mask */
+    constexpr CellValue first( ) const { return bits ? static_cast<CellValue>(std::countr_zero(bits) + 1) : 0; }
+
+    constexpr bool isSubsetOf(CandidateMask o) const { return (bits & ~o.bits) == 0; }
+
+    constexpr const_iterator begin( ) const { return const_iterator(bits); }
+
+    constexpr const_iterator end( ) const { return const_iterator(0); }
+
+    constexpr CandidateMask operator& (CandidateMask o) const { return CandidateMask(bits & o.bits); }
+
+    constexpr CandidateMask operator| (CandidateMask o) const { return CandidateMask(bits | o.bits); }
+
+    constexpr CandidateMask operator^ (CandidateMask o) const { return CandidateMask(bits ^ o.bits); }
+
+    constexpr CandidateMask operator~ ( ) const { return CandidateMask(~bits); }
+
+    constexpr CandidateMask& operator&= (CandidateMask o)
+    {
+        bits &= o.bits;
+        return *this;
+    }
+
+    constexpr CandidateMask& operator|= (CandidateMask o)
+    {
+        bits |= o.bits;
+        return *this;
+    }
+
+    constexpr bool operator== (CandidateMask o) const { return bits == o.bits; }
+
+    constexpr bool operator!= (CandidateMask o) const { return bits != o.bits; }
+};
+
+/*! \brief Candidate masks over values 1..n holding minSize..maxSize values, enumerated lazily
+ *
+ * Nothing is stored: sizes come in ascending order and, within a size, the masks in
+ * ascending numeric order, each one computed from the previous by Gosper's hack.
+ */
+class CandidateCombinations
+{
+    quint8 n;
+    quint8 minSize;
+    quint8 maxSize;
+
+public:
+    class const_iterator
+    {
+        quint64 mask;
+        quint64 limit;
+        quint8  size;
+        quint8  maxSize;
+
+    public:
+        constexpr const_iterator(quint64 mask, quint8 n, quint8 size, quint8 maxSize) : mask(mask), limit(1ULL << n), size(size), maxSize(maxSize) {}
+
+        constexpr CandidateMask operator* ( ) const { return CandidateMask::fromRaw(mask); }
+
+        constexpr const_iterator& operator++ ( )
+        {
+            const quint64 lowest = mask & (~mask + 1);
+            const quint64 ripple = mask + lowest;
+            mask                 = (((ripple ^ mask) >> 2) / lowest) | ripple;
+            if ( mask >= limit )
+                mask = ++size <= maxSize ? (1ULL << size) - 1 : 0;
+            return *this;
+        }
+
+        constexpr bool operator!= (const const_iterator& o) const { return mask != o.mask; }
+
+        constexpr bool operator== (const const_iterator& o) const { return mask == o.mask; }
+    };
+
+    constexpr CandidateCombinations(quint8 n, quint8 minSize, quint8 maxSize) : n(n), minSize(minSize), maxSize(maxSize < n ? maxSize : n) {}
+
+    constexpr bool isEmpty( ) const { return minSize == 0 || minSize > maxSize; }
+
+    constexpr const_iterator begin( ) const { return isEmpty( ) ? end( ) : const_iterator((1ULL << minSize) - 1, n, minSize, maxSize); }
+
+    constexpr const_iterator end( ) const { return const_iterator(0, n, 0, 0); }
+};
+
+inline std::ostream& operator<< (std::ostream& stream, CandidateMask mask)
+{
+    // separated, as 16x16 and 25x25 boards have two digit values
+    const char* separator = "";
+    stream << "{";
+    for ( CellValue v: mask ) {
+        stream << separator << static_cast<int>(v);
+        separator = ",";
+    }
+    stream << "}";
+    return stream;
+}
+
+#endif  // CANDIDATEMASK_H
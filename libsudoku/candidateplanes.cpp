@@ -0,0 +1,44 @@
+#include "candidateplanes.h"
+#include "coord.h"
+
+#include <algorithm>
+
+void CandidatePlanes::reset(quint8 n)
+{
+    CellBitSet allCells;
+    allCells.fill(n * n);
+
+    digitPlanes.fill(allCells, n);
+    solved.clear( );
+
+    this->n = n;
+    s       = Coord::squareSizeFor(n);
+    positions.fill(static_cast<HousePositions>((quint64 {1} << n) - 1), 3 * n * n);
+
+    // new contents: everything counts as changed, numbering goes on
+    touchAll( );
+}
+
+void CandidatePlanes::copyCandidates(const CandidatePlanes& other)
+{
+    n = other.n;
+    s = other.s;
+    if ( digitPlanes.count( ) == other.digitPlanes.count( ) && positions.count( ) == other.positions.count( ) ) {
+        std::copy(other.digitPlanes.cbegin( ), other.digitPlanes.cend( ), digitPlanes.begin( ));
+        std::copy(other.positions.cbegin( ), other.positions.cend( ), positions.begin( ));
+    } else {
+        digitPlanes = other.digitPlanes;
+        positions   = other.positions;
+        // no sharing with other afterwards, the next copy must not allocate
+        digitPlanes.detach( );
+        positions.detach( );
+    }
+    solved = other.solved;
+}
+
+void CandidatePlanes::touchAll( )
+{
+    changes++;
+    cellChanges.fill(changes, n * n);
+    houseChanges.fill(changes, 3 * n);
+}
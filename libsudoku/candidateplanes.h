@@ -0,0 +1,126 @@
+#ifndef CANDIDATEPLANES_H
+#define CANDIDATEPLANES_H
+
+#include "candidatemask.h"
+#include "cellbitset.h"
+
+#include <QVector>
+
+/*! \brief Struct-of-arrays view of the candidates of a whole field
+ *
+ * One CellBitSet per digit holding the unresolved cells that still have this digit
+ * as a candidate, plus one bitboard of resolved cells. Cells keep it in sync from
+ * setValue/removeCandidate, so "where can digit d go in house h" is a single AND
+ * with the house mask.
+ *
+ * The same information is also kept per house, as a mask of positions inside the
+ * house (bit k is the k-th cell of that house, i.e. the column for a row, the row
+ * for a column and the row-major offset for a square). Houses are numbered rows
+ * first, then columns, then squares. Reading a count is then one popcount.
+ *
+ * Every change is also numbered, and the number of the latest change is kept per
+ * cell and per house, so a technique can tell whether a region changed since it
+ * last looked at it.
+ */
+class CandidatePlanes
+{
+public:
+    using HousePositions = quint32;
+
+private:
+    QVector<CellBitSet>     digitPlanes;
+    CellBitSet              solved;
+    QVector<HousePositions> positions;  // [house * n + digit - 1]
+    QVector<quint64>        cellChanges;
+    QVector<quint64>        houseChanges;
+    quint64                 changes {0};
+    quint8                  n {0};
+    quint8                  s {0};
+
+    void touch(quint16 idx)
+    {
+        const quint8 row = idx / n;
+        const quint8 col = idx % n;
+        const quint8 sq  = (row / s) * s + col / s;
+        changes++;
+        cellChanges[idx]         = changes;
+        houseChanges[row]        = changes;
+        houseChanges[n + col]    = changes;
+        houseChanges[2 * n + sq] = changes;
+    }
+
+    void clearPositions(quint16 idx, CellValue v)
+    {
+        const quint8 row = idx / n;
+        const quint8 col = idx % n;
+        const quint8 sq  = (row / s) * s + col / s;
+        positions[row * n + v - 1] &= ~(HousePositions {1} << col);
+        positions[(n + col) * n + v - 1] &= ~(HousePositions {1} << row);
+        positions[(2 * n + sq) * n + v - 1] &= ~(HousePositions {1} << ((row % s) * s + col % s));
+    }
+
+    void setPositions(quint16 idx, CellValue v)
+    {
+        const quint8 row = idx / n;
+        const quint8 col = idx % n;
+        const quint8 sq  = (row / s) * s + col / s;
+        positions[row * n + v - 1] |= HousePositions {1} << col;
+        positions[(n + col) * n + v - 1] |= HousePositions {1} << row;
+        positions[(2 * n + sq) * n + v - 1] |= HousePositions {1} << ((row % s) * s + col % s);
+    }
+
+public:
+    void reset(quint8 n);
+
+    /*! \brief copies the candidates of \a other, size included; change numbers are not copied
+     *
+     * Reuses the storage of this object when the sizes match, so it is a plain copy.
+     */
+    void copyCandidates(const CandidatePlanes& other);
+
+    /*! \brief numbers a change of every cell and house, as reset() does */
+    void touchAll( );
+
+    /*! \brief positions inside \a house where \a val is still a candidate of an unresolved cell */
+    HousePositions housePositions(quint8 house, CellValue val) const { return positions[house * n + val - 1]; }
+
+    const CellBitSet& digit(CellValue val) const { return digitPlanes[val - 1]; }
+
+    const CellBitSet& solvedCells( ) const { return solved; }
+
+    /*! \brief number of the latest change anywhere; only grows, reset() included */
+    quint64 lastChange( ) const { return changes; }
+
+    quint64 lastCellChange(quint16 idx) const { return cellChanges[idx]; }
+
+    quint64 lastHouseChange(quint8 house) const { return houseChanges[house]; }
+
+    void removeCandidates(quint16 idx, CandidateMask removed)
+    {
+        if ( !removed.isEmpty( ) )
+            touch(idx);
+        for ( CellValue v: removed ) {
+            digitPlanes[v - 1].reset(idx);
+            clearPositions(idx, v);
+        }
+    }
+
+    void setValue(quint16 idx, CandidateMask previous)
+    {
+        removeCandidates(idx, previous);
+        touch(idx);
+        solved.set(idx);
+    }
+
+    void resetCell(quint16 idx, CandidateMask candidates)
+    {
+        touch(idx);
+        solved.reset(idx);
+        for ( CellValue v: candidates ) {
+            digitPlanes[v - 1].set(idx);
+            setPositions(idx, v);
+        }
+    }
+};
+
+#endif  // CANDIDATEPLANES_H
@@ -1,15 +1,12 @@
 #include "cell.h"
+#include "celltrail.h"
 #include "house.h"
+#include "log.h"
 #include <iostream>
-#include <chrono>
-#include <thread>
 
-//#define DELAY_SET_VALUE
-
-Cell::Cell(quint8 n, QObject* parent)
-    :QObject(parent)
+Cell::Cell(quint8 n)
     #ifdef MT
-    , accessLock(QReadWriteLock::Recursive)
+    :accessLock(QReadWriteLock::Recursive)
     #endif
 {
     if (n>0)
@@ -21,50 +18,72 @@ CellValue Cell::value() const
 #ifdef MT
     QReadLocker locker(&accessLock);
 #endif
-    return val;
+    return state->value;
 }
 
 void Cell::setValue(CellValue val, bool init_value)
 {
+    if (trail)
+        trail->record(coord().rawIndex(), *state);
     {
         #ifdef MT
             QWriteLocker locker(&accessLock);
         #endif
-        this->val = val;
-        candidateMask.fill(false);
-        candidateMask.setBit(val-1, true);
-    }
-    initial_value = init_value;
-    LOG_STREAM << "\tvalue " << (int)val << " set into " << coord() << std::endl;
-    emit valueAboutToBeSet(val);
-#ifdef  DELAY_SET_VALUE
-    if (useDelay)
-    {
-        using namespace  std::chrono_literals;
-        auto t0 = std::chrono::steady_clock::now() + 100ms;
-        std::this_thread::sleep_until (t0);
+        state->value = val;
+        if (planes)
+            planes->setValue(coord().rawIndex(), state->candidates);
+        state->candidates = CandidateMask::single(val);
     }
-#endif
+    state->initial = init_value;
+    SUDOKU_LOG(Trace) << "\tvalue " << (int)val << " set into " << coord() << '\n';
+    if (observer)
+        observer->valueAboutToBeSet(this, val);
 
     for(House::Ptr pArea: houses)
     {
         pArea->removeCandidate(val);
     }
-#ifdef  DELAY_SET_VALUE
-    if(useDelay)
+    if (observer)
+        observer->valueSet(this, val);
+}
+
+void Cell::assignState(CellValue val, CandidateMask mask, bool init_value)
+{
+    if (trail)
+        trail->record(coord().rawIndex(), *state);
+    restoreState({val ? CandidateMask::single(val) : mask, val, init_value});
+    if (observer)
     {
-        using namespace  std::chrono_literals;
-        auto t0 = std::chrono::steady_clock::now() + 100ms;
-        std::this_thread::sleep_until (t0);
+        if (val)
+            observer->valueSet(this, val);
+        else if (mask != CandidateMask::all(capacity))
+            observer->candidatesRemoved(this, CandidateMask::all(capacity) & ~mask);
     }
+}
+
+void Cell::restoreState(const State& saved)
+{
+#ifdef MT
+    QWriteLocker locker(&accessLock);
 #endif
-    emit valueSet(val);
+    if (planes)
+    {
+        planes->removeCandidates(coord().rawIndex(), state->candidates);
+        if (saved.value)
+            planes->setValue(coord().rawIndex(), CandidateMask());
+        else
+            planes->resetCell(coord().rawIndex(), saved.candidates);
+    }
+    *state = saved;
 }
 
 void Cell::removeValue()
 {
-    val = 0;
-    emit valueRemoved();
+    if (trail)
+        trail->record(coord().rawIndex(), *state);
+    state->value = 0;
+    if (observer)
+        observer->valueRemoved(this);
 }
 
 bool Cell::removeCandidate(CellValue guessVal)
@@ -74,88 +93,68 @@ bool Cell::removeCandidate(CellValue guessVal)
         return false;
 //        throw std::runtime_error("removing guess from known value");
     }
-    if (!candidateMask.testBit(guessVal-1))
+    if (!state->candidates.hasCandidate(guessVal))
     {
         //throw std::runtime_error("removing unset guess");
         return false;
     }
-    emit candidateAboutToBeRemoved(guessVal);
-#ifdef  DELAY_SET_VALUE
-    if (useDelay)
-    {
-        using namespace  std::chrono_literals;
-        auto t0 = std::chrono::steady_clock::now() + 500ms;
-        std::this_thread::sleep_until (t0);
-    }
-#endif
+    if (trail)
+        trail->record(coord().rawIndex(), *state);
+    if (observer)
+        observer->candidatesAboutToBeRemoved(this, CandidateMask::single(guessVal));
     {
 #ifdef MT
         QWriteLocker locker(&accessLock);
 #endif
-        candidateMask.clearBit(guessVal-1);
+        state->candidates.clearCandidate(guessVal);
+        if (planes)
+            planes->removeCandidates(coord().rawIndex(), CandidateMask::single(guessVal));
     }
 
-    if (candidateMask.count(true) == 0)
+    if (state->candidates.isEmpty())
         throw std::runtime_error("no guesses left -- something wrong with algorithm or puzzle");
-    LOG_STREAM << "\tcandidate " << (int)guessVal << " removed from " << coord() << std::endl;
-    emit candidateRemoved(guessVal);
-#ifdef  DELAY_SET_VALUE
-    if (useDelay)
-    {
-        using namespace  std::chrono_literals;
-        auto t0 = std::chrono::steady_clock::now() + 50ms;
-        std::this_thread::sleep_until (t0);
-    }
-#endif
+    SUDOKU_LOG(Trace) << "\tcandidate " << (int)guessVal << " removed from " << coord() << '\n';
+    if (observer)
+        observer->candidatesRemoved(this, CandidateMask::single(guessVal));
     return true;
 }
 
-bool Cell::removeCandidate(const QBitArray& candidate)
+bool Cell::removeCandidate(CandidateMask candidate)
 {
     if (isResolved())
     {
         return false;
 //        throw std::runtime_error("trying to remove candaidate from resolved cell");
     }
-    if ((candidateMask & candidate).count(true) == 0)
+    CandidateMask removed = state->candidates & candidate;
+    if (removed.isEmpty())
         return false; // nothing will be removed
-    emit candidatesAboutToBeRemoved(candidate);
-#ifdef  DELAY_SET_VALUE
-    if (useDelay)
-    {
-        using namespace  std::chrono_literals;
-        auto t0 = std::chrono::steady_clock::now() + 500ms;
-        std::this_thread::sleep_until (t0);
-    }
-#endif
-    QBitArray oldCandidates = candidateMask;
+    if (trail)
+        trail->record(coord().rawIndex(), *state);
+    if (observer)
+        observer->candidatesAboutToBeRemoved(this, removed);
     {
         #ifdef MT
             QWriteLocker locker(&accessLock);
         #endif
-        candidateMask &= ~candidate;
+        state->candidates &= ~removed;
+        if (planes)
+            planes->removeCandidates(coord().rawIndex(), removed);
     }
-    if (candidateMask.count(true) == 0)
+    if (state->candidates.isEmpty())
         throw std::runtime_error("no guesses left -- something wrong with algorithm or sudoku");
-    LOG_STREAM << "\tcandidates " << candidate << "removed from " << coord() << std::endl;
-    emit candidatesRemoved(candidate);
-#ifdef  DELAY_SET_VALUE
-    if (useDelay)
-    {
-        using namespace  std::chrono_literals;
-        auto t0 = std::chrono::steady_clock::now() + 50ms;
-        std::this_thread::sleep_until (t0);
-    }
-#endif
-    return oldCandidates != candidateMask;
+    SUDOKU_LOG(Trace) << "\tcandidates " << removed << " removed from " << coord() << '\n';
+    if (observer)
+        observer->candidatesRemoved(this, removed);
+    return true;
 }
 
-bool Cell::candidatesExactMatch(const QBitArray& mask) const
+bool Cell::candidatesExactMatch(CandidateMask mask) const
 {
 #ifdef MT
     QReadLocker locker(&accessLock);
 #endif
-    return (candidateMask & mask) == candidateMask;
+    return state->candidates.isSubsetOf(mask);
 }
 
 bool Cell::candidatesExactMatch(Cell::CPtr o) const
@@ -163,7 +162,7 @@ bool Cell::candidatesExactMatch(Cell::CPtr o) const
 #ifdef MT
     QReadLocker locker(&accessLock);
 #endif
-    return candidateMask == o->candidateMask;
+    return state->candidates == o->state->candidates;
 }
 
 bool Cell::hasCandidate(CellValue guessVal) const
@@ -171,27 +170,27 @@ bool Cell::hasCandidate(CellValue guessVal) const
 #ifdef MT
     QReadLocker locker(&accessLock);
 #endif
-    if (guessVal > candidateMask.count() || guessVal < 1)
+    if (guessVal > capacity || guessVal < 1)
     {
         throw std::out_of_range("candidate is out of range");
         //return false;
     }
-    return candidateMask.testBit(guessVal-1);
+    return state->candidates.hasCandidate(guessVal);
 }
 
-int Cell::hasAnyOfCandidates(const QBitArray& mask) const
+int Cell::hasAnyOfCandidates(CandidateMask mask) const
 {
 #ifdef MT
     QReadLocker locker(&accessLock);
 #endif
-    return (candidateMask & mask).count(true);
+    return (state->candidates & mask).count();
 }
 
 void Cell::print(std::ostream& stream) const
 {
     if (!isResolved())
     {
-        stream << candidateMask;
+        stream << state->candidates;
     }
     else
         stream << (int)value();
@@ -203,48 +202,71 @@ void Cell::registerInHouse(House& house)
     house.addCell(this);
 }
 
+void Cell::attachPlanes(CandidatePlanes* planes)
+{
+    this->planes = planes;
+}
+
+void Cell::attachObserver(CellObserver* observer)
+{
+    this->observer = observer;
+}
+
+void Cell::attachState(State* storage)
+{
+    state = storage;
+}
+
+void Cell::attachTrail(CellTrail* trail)
+{
+    this->trail = trail;
+}
+
 void Cell::resetCandidates(quint8 n)
 {
 #ifdef MT
     QWriteLocker locker(&accessLock);
 #endif
-    val = 0;
-    candidateMask.resize(n);
-    candidateMask.fill(true);
+    state->value = 0;
+    capacity = n;
+    state->candidates = CandidateMask::all(n);
+    if (planes)
+        planes->resetCell(coord().rawIndex(), state->candidates);
     removeValue();
-    emit candidatesReset();
+    if (observer)
+        observer->candidatesReset(this);
 }
 
 bool Cell::isValid() const
 {
-    return     (isResolved() && candidateMask.count(true) == 1 && candidateMask.at(value()-1))
-            || (!isResolved() && candidateMask.count(true) > 1);
+    return     (isResolved() && state->candidates == CandidateMask::single(value()))
+            || (!isResolved() && state->candidates.count() > 1);
 }
 
 QVector<CellValue> Cell::candidates() const
 {
     QVector<CellValue> ret;
-    for (CellValue i=1; i<=candidatesCapacity(); i++)
-        if (hasCandidate(i))
-            ret.append(i);
+    for (CellValue i: candidatesMask())
+        ret.append(i);
     return ret;
 }
 
-void Cell::setDelay(bool use)
+CandidateMask Cell::candidatesMask() const
 {
-    useDelay =  use;
+#ifdef MT
+    QReadLocker locker(&accessLock);
+#endif
+    return state->candidates;
 }
 
-QBitArray Cell::commonCandidates(Cell::CPtr a) const
+CandidateMask Cell::commonCandidates(Cell::CPtr a) const
 {
-    QBitArray ret(candidatesCapacity());
-    ret = candidateMask & a->candidateMask;
-    return ret;
+    return state->candidates & a->state->candidates;
 }
 
 int Cell::commonCandidatesCount(Cell::CPtr a) const
 {
-    return commonCandidates(a).count(true);
+    return commonCandidates(a).count();
 }
 
 bool Cell::operator ==(const Cell& other) const
@@ -252,28 +274,14 @@ bool Cell::operator ==(const Cell& other) const
     return coord() == other.coord();
 }
 
-void Cell::reset(quint8 n, quint8 idx)
+void Cell::reset(quint8 n, quint16 idx)
 {
     houses.clear();
-    coord().setRawIndex(idx);
+    coordinate = Coord::fromRawIndex(idx, n);
     resetCandidates(n);
-    setDelay(false);
 
-    emit reseted();
-}
-
-std::ostream& operator <<(std::ostream& stream, const QBitArray& arr)
-{
-    stream << "{";
-    for (int i=0; i<arr.count(); i++)
-    {
-        if (arr.testBit(i))
-        {
-            stream << i+1;
-        }
-    }
-    stream << "}";
-    return stream;
+    if (observer)
+        observer->cellReset(this);
 }
 
 std::ostream& operator << (std::ostream& stream, const Cell& cell)
@@ -1,11 +1,16 @@
 #pragma once
+#include "candidatemask.h"
 #include "coord.h"
+#include "candidateplanes.h"
+#include "observer.h"
 #include <iostream>
-#include <QBitArray>
+#include <QMetaType>
 #include <QVector>
-#include <QObject>
+#ifdef MT
 #include <QReadWriteLock>
+#endif
 class House;
+class CellTrail;
 
 //class Value
 //{
@@ -23,67 +28,79 @@ class House;
 //    bool presentInMask (const QBitArray& a) const { return a.testBit(val-1); }
 //};
 
-using CellValue = quint8;
 Q_DECLARE_METATYPE(CellValue)
+Q_DECLARE_METATYPE(CandidateMask)
 
-class Cell: public QObject
+class Cell
 {
-    Q_OBJECT
+public:
+    /// what a cell knows, kept by Field in one contiguous array so it can be saved with a memcpy
+    struct State
+    {
+        CandidateMask candidates;
+        CellValue     value{0};
+        bool          initial{false};
+    };
 
-    CellValue    val{0};
-    QBitArray candidateMask;
-    bool initial_value{false};
+private:
+    State        ownState;              // used until the cell is attached to a field
+    State*       state{&ownState};
+    quint8       capacity{0};
     Coord coordinate;
     QVector<House*> houses;
-    //Cell& operator = (const Cell& );
-    bool useDelay{false};
+    CandidatePlanes* planes{nullptr};
+    CellObserver* observer{nullptr};
+    CellTrail* trail{nullptr};
 
+#ifdef MT
     mutable QReadWriteLock accessLock;
+#endif
 
 public:
     using Ptr =  Cell*;
     using CPtr = const Cell*;
-    Cell(quint8 n = 0, QObject* parent = nullptr);
+    Cell(quint8 n = 0);
+    Cell(const Cell&) = delete;  // would share the state storage
+    Cell& operator = (const Cell&) = delete;
 
     CellValue value() const;
-    bool isInitialValue() const {return initial_value;}
+    bool isInitialValue() const {return state->initial;}
     void setValue(CellValue val, bool init_value = false);
+    /*! \brief overwrites the cell state as is, without touching its houses */
+    void assignState(CellValue val, CandidateMask mask, bool init_value);
+    /*! \brief puts back \a saved as is: no houses, observer or trail are involved */
+    void restoreState(const State& saved);
+    const State& currentState() const { return *state; }
     void removeValue();
     bool removeCandidate(CellValue val);
-    int candidatesCapacity() const {return candidateMask.count();}
-    int candidatesCount() const {return candidateMask.count(true);}
+    int candidatesCapacity() const {return capacity;}
+    int candidatesCount() const {return state->candidates.count();}
     bool isResolved() const {return value() != 0;}
     bool hasCandidate(CellValue val) const;
     void print(std::ostream& stream) const;
     void registerInHouse(House& house);
+    void attachPlanes(CandidatePlanes* planes);
+    void attachObserver(CellObserver* observer);
+    /*! \brief keeps the cell state in \a storage from now on; whatever \a storage holds becomes the state */
+    void attachState(State* storage);
+    /*! \brief records every change into \a trail before making it, nullptr stops; not owned */
+    void attachTrail(CellTrail* trail);
     Coord& coord() { return coordinate;}
     const Coord& coord() const { return coordinate;}
     void resetCandidates(quint8 n);
     bool isValid() const;
     QVector<CellValue> candidates() const;
-    QBitArray commonCandidates(Cell::Ptr o) const { return candidateMask & o->candidateMask;}
-    void setDelay(bool use = true);
-    bool removeCandidate(const QBitArray& candidate);
-    bool candidatesExactMatch(const QBitArray& mask) const;
+    CandidateMask candidatesMask() const;
+    bool removeCandidate(CandidateMask candidate);
+    bool candidatesExactMatch(CandidateMask mask) const;
     bool candidatesExactMatch(Cell::CPtr o) const;
-    int hasAnyOfCandidates(const QBitArray& mask) const;
-    QBitArray commonCandidates(Cell::CPtr a) const;
+    int hasAnyOfCandidates(CandidateMask mask) const;
+    CandidateMask commonCandidates(Cell::CPtr a) const;
     int commonCandidatesCount(Cell::CPtr a) const;
 
     bool operator == (const Cell& other) const;
 
-    void reset(quint8 n, quint8 idx);
-signals:
-    void valueSet(CellValue);
-    void candidatesReset();
-    void valueRemoved();
-    void reseted();
-    void valueAboutToBeSet(CellValue);
-    void candidateRemoved(CellValue);
-    void candidateAboutToBeRemoved(CellValue);
-    void candidatesRemoved(QBitArray);
-    void candidatesAboutToBeRemoved(QBitArray);
+    void reset(quint8 n, quint16 idx);
 };
 
-std::ostream& operator << (std::ostream& stream, const QBitArray& arr);
 std::ostream& operator << (std::ostream& stream, const Cell& cell);
@@ -0,0 +1,147 @@
+#ifndef CELLBITSET_H
+#define CELLBITSET_H
+
+#include <QtCore/qglobal.h>
+
+#include <array>
+#include <bit>
+
+/*! \brief Fixed-size set of cell indices (Coord::rawIndex), big enough for 25x25
+ *
+ * Stored inline as an array of words, so copies and set operations never allocate.
+ * Iteration yields indices in ascending order.
+ */
+class CellBitSet
+{
+public:
+    static constexpr int WordsCount = 10;
+    static constexpr int MaxCells   = WordsCount * 64;
+
+private:
+    std::array<quint64, WordsCount> words {};
+
+public:
+    class const_iterator
+    {
+        const quint64* words;
+        int            wordIdx;
+        quint64        rest;
+
+        constexpr void skipEmptyWords( )
+        {
+            while ( !rest && ++wordIdx < WordsCount )
+                rest = words[wordIdx];
+            if ( !rest )
+                wordIdx = WordsCount;
+        }
+
+    public:
+        constexpr const_iterator(const quint64* words, int wordIdx) : words(words), wordIdx(wordIdx), rest(wordIdx < WordsCount ? words[wordIdx] : 0) { skipEmptyWords( ); }
+
+        constexpr quint16 operator* ( ) const { return static_cast<quint16>(wordIdx * 64 + std::countr_zero(rest)); }
+
+        constexpr const_iterator& operator++ ( )
+        {
+            rest &= rest - 1;
+            skipEmptyWords( );
+            return *this;
+        }
+
+        constexpr bool operator== (const const_iterator& o) const { return wordIdx == o.wordIdx && rest == o.rest; }
+
+        constexpr bool operator!= (const const_iterator& o) const { return !(*this == o); }
+    };
+
+    constexpr CellBitSet( ) = default;
+
+    constexpr void set(quint16 idx) { words[idx / 64] |= 1ULL << (idx % 64); }
+
+    constexpr void reset(quint16 idx) { words[idx / 64] &= ~(1ULL << (idx % 64)); }
+
+    constexpr bool test(quint16 idx) const { return words[idx / 64] & (1ULL << (idx % 64)); }
+
+    constexpr void clear( ) { words.fill(0); }
+
+    /*! \brief sets indices [0, count) */
+    constexpr void fill(quint16 count)
+    {
+        clear( );
+        for ( int w = 0; w * 64 < count; w++ ) {
+            const int bits = count - w * 64;
+            words[w]       = bits >= 64 ? ~0ULL : (1ULL << bits) - 1;
+        }
+    }
+
+    constexpr int count( ) const
+    {
+        int ret = 0;
+        for ( quint64 w: words )
+            ret += std::popcount(w);
+        return ret;
+    }
+
+    constexpr bool isEmpty( ) const
+    {
+        for ( quint64 w: words )
+            if ( w )
+                return false;
+        return true;
+    }
+
+    constexpr bool intersects(const CellBitSet& o) const
+    {
+        for ( int w = 0; w < WordsCount; w++ )
+            if ( words[w] & o.words[w] )
+                return true;
+        return false;
+    }
+
+    /*! \brief lowest index in the set, MaxCells for empty set */
+    constexpr quint16 first( ) const
+    {
+        for ( int w = 0; w < WordsCount; w++ )
+            if ( words[w] )
+                return static_cast<quint16>(w * 64 + std::countr_zero(words[w]));
+        return MaxCells;
+    }
+
+    constexpr quint64 word(int w) const { return words[w]; }
+
+    constexpr const_iterator begin( ) const { return const_iterator(words.data( ), 0); }
+
+    constexpr const_iterator end( ) const { return const_iterator(words.data( ), WordsCount); }
+
+    constexpr CellBitSet& operator&= (const CellBitSet& o)
+    {
+        for ( int w = 0; w < WordsCount; w++ )
+            words[w] &= o.words[w];
+        return *this;
+    }
+
+    constexpr CellBitSet& operator|= (const CellBitSet& o)
+    {
+        for ( int w = 0; w < WordsCount; w++ )
+            words[w] |= o.words[w];
+        return *this;
+    }
+
+    /*! \brief removes all indices present in \a o */
+    constexpr CellBitSet& operator-= (const CellBitSet& o)
+    {
+        for ( int w = 0; w < WordsCount; w++ )
+            words[w] &= ~o.words[w];
+        return *this;
+    }
+
+    constexpr CellBitSet operator& (const CellBitSet& o) const { return CellBitSet(*this) &= o; }
+
+    constexpr CellBitSet operator| (const CellBitSet& o) const { return CellBitSet(*this) |= o; }
+
+    constexpr CellBitSet operator- (const CellBitSet& o) const { return CellBitSet(*this) -= o; }
+
+    constexpr bool operator== (const CellBitSet& o) const { return words == o.words; }
+
+    constexpr bool operator!= (const CellBitSet& o) const { return words != o.words; }
+};
+
+#endif  // CELLBITSET_H
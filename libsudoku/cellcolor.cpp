@@ -2,8 +2,6 @@
 #include "bilocationlink.h"
 #include "cell.h"
 
-QVector<QPair<CellColor, CellColor>> ColorPair::pairs;
-
 CellColor ColoredLinksVault::getColor(Cell* cell) const
 {
     for(const CellColor& color: map.keys())
@@ -31,36 +29,16 @@ void ColoredLinksVault::recolor(CellColor from, CellColor to)
     map.remove(from);
 }
 
-bool ColoredLinksVault::removeCandidateForColor(CellColor color)
+CellColor ColoredLinksVault::antiColor(CellColor color) const
 {
-    bool changed = false;
-    CellColor acolor = ColorPair::antiColor(color);
-    for(Cell* cell: map[color])
-        changed |= cell->removeCandidate(candidateValue);
-    for(Cell* cell: map[acolor])
-        cell->setValue(candidateValue);
-    return changed;
-}
-
-CellColor ColorPair::antiColor(const CellColor& color)
-{
-    for (const QPair<CellColor, CellColor>& pair: pairs)
-        if (pair.first == color)
-            return pair.second;
-        else if (pair.second == color)
-            return pair.first;
-    return ColorPair::UnknownColor;
+    if (color < 0 || color >= nextColor)
+        return ColorPair::UnknownColor;
+    return color ^ 1;
 }
 
-ColorPair ColorPair::newPair()
+ColorPair ColoredLinksVault::newPair()
 {
-    static int nextColor = 0;
-    ColorPair pair;
-    pair.color1 = nextColor++;
-    pair.color2 = nextColor++;
-    QPair<CellColor, CellColor> p;
-    p.first = pair.color1;
-    p.second = pair.color2;
-    pairs.append(p);
+    ColorPair pair(nextColor, nextColor + 1);
+    nextColor += 2;
     return pair;
 }
@@ -12,29 +12,34 @@ typedef int CellColor;
 
 class ColorPair
 {
-    static QVector<QPair<CellColor, CellColor>> pairs;
     CellColor color1;
     CellColor color2;
 public:
     static const CellColor UnknownColor = -1;
+    ColorPair(CellColor c1, CellColor c2):color1(c1), color2(c2){}
     CellColor first() const {return color1;}
     CellColor second() const {return color2;}
-    static CellColor antiColor(const CellColor& color);
-    static ColorPair newPair();
 };
 
+/*! \brief colored cells of one candidate
+ *
+ * Colors are handed out by the vault itself in pairs (2k, 2k+1), so every
+ * coloring run starts from scratch and no state is shared between runs.
+ */
 class ColoredLinksVault
 {
     quint8 candidateValue;
+    CellColor nextColor{0};
     QMap<CellColor, QVector<Cell*>> map;
 public:
     ColoredLinksVault(quint8 candidate):candidateValue(candidate){}
+    ColorPair newPair();
+    CellColor antiColor(CellColor color) const;
     CellColor getColor(Cell* cell) const;
     void addLink(const BiLocationLink& link, ColorPair cp);
     void addCell(Cell* cell, CellColor color);
     void recolor(CellColor from, CellColor to);
-
-    bool removeCandidateForColor(CellColor color);
+    const QVector<Cell*> cells(CellColor color) const { return map.value(color); }
 };
 
 #endif // CELLCOLOR_H
@@ -0,0 +1,9 @@
+#include "celltrail.h"
+#include "field.h"
+
+void CellTrail::undo(Field& field, Mark to)
+{
+    for ( qsizetype i = entries.count( ) - 1; i >= to; i-- )
+        field.cellAt(entries[i].idx)->restoreState(entries[i].state);
+    entries.resize(to);
+}
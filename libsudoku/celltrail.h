@@ -0,0 +1,43 @@
+#ifndef CELLTRAIL_H
+#define CELLTRAIL_H
+
+#include "cell.h"
+
+#include <QVector>
+
+class Field;
+
+/*! \brief Undo journal of cell changes for deep search
+ *
+ * While attached to a Field (Field::setTrail()) every cell records its state just
+ * before it changes. A search takes a mark() before a guess and calls undo() with it
+ * to backtrack, paying only for the cells that really changed, where a snapshot
+ * restore always copies the whole board. Undo goes through Cell::restoreState(), so
+ * candidate planes stay in sync and observers are not notified.
+ */
+class CellTrail
+{
+    struct Entry
+    {
+        quint16     idx;
+        Cell::State state;
+    };
+
+    QVector<Entry> entries;
+
+public:
+    using Mark = qsizetype;
+
+    /// position to come back to with undo()
+    Mark mark( ) const { return entries.count( ); }
+
+    void record(quint16 idx, const Cell::State& before) { entries.append({idx, before}); }
+
+    /*! \brief puts back every change recorded after \a to, newest first, and forgets them */
+    void undo(Field& field, Mark to);
+
+    void      clear( ) { entries.clear( ); }
+    qsizetype size( ) const { return entries.count( ); }
+};
+
+#endif  // CELLTRAIL_H
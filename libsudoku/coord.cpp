@@ -1,25 +1,21 @@
 #include "coord.h"
 #include <stdexcept>
-#include <QtMath>
-#include <QVector>
-
-quint8 Coord::N = 0;
 
 Coord::Coord()
-    :rowIdx(0), colIdx(0), rawIdx(0)
+    :N(0), S(0), rowIdx(0), colIdx(0), rawIdx(0)
 {    }
 
-Coord::Coord(quint8 row, quint8 col)
-    :rowIdx(row), colIdx(col), rawIdx((row-1)*Coord::N+(col-1))
+Coord::Coord(quint8 row, quint8 col, quint8 n)
+    :N(n), S(squareSizeFor(n)), rowIdx(row), colIdx(col), rawIdx((row-1)*n+(col-1))
 {
     if (N<4)
-        throw std::runtime_error("Coord::N not set");
+        throw std::runtime_error("Coord board size not set");
 #ifdef INVALID_COORD_EXCEPTION
-    if (row < 1 || row > Coord::N)
+    if (row < 1 || row > N)
         throw std::out_of_range("coord row is out of range");
-    if (col < 1 || col > Coord::N)
+    if (col < 1 || col > N)
         throw std::out_of_range("coord col is out of range");
-    if (rawIdx >= Coord::N * Coord::N)
+    if (rawIdx >= N * N)
         throw std::out_of_range("coord rawIndex is out of range");
 #endif
 }
@@ -54,10 +50,14 @@ quint8 Coord::col() const
 
 quint8 Coord::squareIdx() const
 {
-    quint8 s_n = static_cast<quint8>(qSqrt(Coord::N));
-    quint8 s_col = (colIdx - 1) / s_n;
-    quint8 s_row = (rowIdx - 1) / s_n;
-    return s_row * s_n + s_col;
+    quint8 s_col = (colIdx - 1) / S;
+    quint8 s_row = (rowIdx - 1) / S;
+    return s_row * S + s_col;
+}
+
+Coord Coord::fromRawIndex(quint16 idx, quint8 n)
+{
+    return {static_cast<quint8>(idx / n + 1), static_cast<quint8>(idx % n + 1), n};
 }
 
 quint16 Coord::rawIndex() const
@@ -68,28 +68,28 @@ quint16 Coord::rawIndex() const
 void Coord::setRawIndex(quint16 idx)
 {
 #ifdef INVALID_COORD_EXCEPTION
-    if (idx >= Coord::N * Coord::N)
+    if (idx >= N * N)
         throw std::out_of_range("coord rawIndex is out of range");
 #endif
     rawIdx = idx;
-    colIdx = idx % Coord::N + 1;
-    rowIdx = idx / Coord::N + 1;
+    colIdx = idx % N + 1;
+    rowIdx = idx / N + 1;
 }
 
 void Coord::setRowCol(quint8 row, quint8 col)
 {
 #ifdef INVALID_COORD_EXCEPTION
-    if (row < 1 || row > Coord::N)
+    if (row < 1 || row > N)
         throw std::out_of_range("coord row is out of range");
-    if (col < 1 || col > Coord::N)
+    if (col < 1 || col > N)
         throw std::out_of_range("coord col is out of range");
 #endif
     this->rowIdx = row;
     this->colIdx = col;
-    rawIdx = (row-1) * Coord::N + (col-1);
+    rawIdx = (row-1) * N + (col-1);
 }
 
-quint16 Coord::maxRawIndex()
+quint16 Coord::maxRawIndex() const
 {
     return N*N-1;
 }
@@ -99,59 +99,14 @@ bool Coord::isValid() const
     return rowIdx > 0 && rowIdx <= N && colIdx > 0 && colIdx <= N && rawIdx <= maxRawIndex();
 }
 
-void Coord::init(quint8 n)
-{
-    Coord::N = n;
-}
-
-Coord Coord::first()
-{
-    if (N<4)
-        throw std::runtime_error("Coord::N not set");
-    return {1,1};
-}
-
-Coord Coord::last()
-{
-    if (N<4)
-        throw std::runtime_error("Coord::N not set");
-    return {N, N};
-}
-
-QVector<Coord> Coord::sameColumnCoordinates() const
-{
-    QVector<Coord> ret;
-    for(quint8 r=1; r<=Coord::N; r++)
-        if (r != row())
-            ret.append(Coord(r, col()));
-    return ret;
-}
-
-QVector<Coord> Coord::sameRowCoordinates() const
+Coord Coord::first(quint8 n)
 {
-    QVector<Coord> ret;
-    for(quint8 c=1; c<=Coord::N; c++)
-        if (c != col())
-            ret.append(Coord(row(), c));
-    return ret;
+    return {1, 1, n};
 }
 
-QVector<Coord> Coord::sameSquareCoordinates() const
+Coord Coord::last(quint8 n)
 {
-    QVector<Coord> ret;
-    auto s_n = static_cast<quint8>(qSqrt(Coord::N));
-    quint8 s_row = squareIdx() / s_n;
-    quint8 s_col = squareIdx() % s_n;
-    Coord co;
-    for (quint8 r = s_row * s_n; r < (s_row+1) * s_n; r++)
-        for (quint8 c = s_col * s_n; c < (s_col+1) * s_n; c++)
-        {
-            co = Coord(r+1,c+1);
-            if (*this == co)
-                continue;
-            ret.append(co);
-        }
-    return ret;
+    return {n, n, n};
 }
 
 bool Coord::operator <(const Coord& o) const
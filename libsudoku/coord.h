@@ -4,34 +4,44 @@
 #include <QtCore/qglobal.h>
 #include <iostream>
 
+/*! \brief 1-based row/column position on a NxN board
+ *
+ * Coord carries the size of its board, so coordinates of differently sized
+ * fields can coexist in one process.
+ */
 class Coord
 {
-    static quint8 N;
+    quint8  N;
+    quint8  S;
     quint8  rowIdx;
     quint8  colIdx;
     quint16 rawIdx;
 public:
-    static void init(quint8 n);
+    static constexpr quint8 squareSizeFor(quint8 n)
+    {
+        quint8 s = 0;
+        while ((s + 1) * (s + 1) <= n)
+            s++;
+        return s;
+    }
 
     Coord();
-    Coord(quint8 row, quint8 col);
+    Coord(quint8 row, quint8 col, quint8 n);
+    static Coord fromRawIndex(quint16 idx, quint8 n);
 
     Coord& operator++(int);
 
     quint8 row() const;
     quint8 col() const;
     quint8 squareIdx() const;
+    quint8 boardSize() const { return N; }
     quint16 rawIndex() const;
     void setRawIndex(quint16 idx);
     void setRowCol(quint8 row, quint8 col);
-    static quint16 maxRawIndex();
+    quint16 maxRawIndex() const;
     bool isValid() const;
-    static Coord first();
-    static Coord last();
-
-    QVector<Coord> sameColumnCoordinates() const;
-    QVector<Coord> sameRowCoordinates() const;
-    QVector<Coord> sameSquareCoordinates() const;
+    static Coord first(quint8 n);
+    static Coord last(quint8 n);
 
     bool operator < (const Coord& o) const;
     bool operator > (const Coord& o) const;
@@ -0,0 +1,181 @@
+#include "dlxsolver.h"
+#include "field.h"
+#include "geometry.h"
+
+DlxSolver::DlxSolver(const Geometry& geometry)
+    : N(geometry.getN( ))
+{
+    const qint32 cellsCount = geometry.cellsCount( );
+    columnsCount            = 4 * cellsCount;
+    firstRowNode            = columnsCount + 1;
+
+    nodes.resize(firstRowNode + 4 * cellsCount * N);
+    columnSize.fill(0, columnsCount + 1);
+
+    for ( qint32 c = 0; c <= columnsCount; c++ )
+        nodes[c] = {c - 1, c + 1, c, c, c};
+    nodes[0].left             = columnsCount;
+    nodes[columnsCount].right = 0;
+
+    for ( qint32 row = 0; row < cellsCount * N; row++ ) {
+        const qint32 cell  = row / N;
+        const qint32 digit = row % N;
+
+        const qint32 columns[4] = {1 + cell,
+                                   1 + cellsCount + geometry.row(cell) * N + digit,
+                                   1 + 2 * cellsCount + geometry.column(cell) * N + digit,
+                                   1 + 3 * cellsCount + geometry.square(cell) * N + digit};
+        const qint32 first      = firstRowNode + 4 * row;
+        for ( qint32 k = 0; k < 4; k++ ) {
+            const qint32 idx    = first + k;
+            const qint32 column = columns[k];
+            nodes[idx]          = {first + (k + 3) % 4, first + (k + 1) % 4, nodes[column].up, column, column};
+            nodes[nodes[column].up].down = idx;
+            nodes[column].up             = idx;
+            columnSize[column]++;
+        }
+    }
+}
+
+void DlxSolver::cover(qint32 column)
+{
+    nodes[nodes[column].right].left = nodes[column].left;
+    nodes[nodes[column].left].right = nodes[column].right;
+    for ( qint32 i = nodes[column].down; i != column; i = nodes[i].down ) {
+        for ( qint32 j = nodes[i].right; j != i; j = nodes[j].right ) {
+            nodes[nodes[j].down].up = nodes[j].up;
+            nodes[nodes[j].up].down = nodes[j].down;
+            columnSize[nodes[j].column]--;
+        }
+    }
+}
+
+void DlxSolver::uncover(qint32 column)
+{
+    for ( qint32 i = nodes[column].up; i != column; i = nodes[i].up ) {
+        for ( qint32 j = nodes[i].left; j != i; j = nodes[j].left ) {
+            columnSize[nodes[j].column]++;
+            nodes[nodes[j].down].up = j;
+            nodes[nodes[j].up].down = j;
+        }
+    }
+    nodes[nodes[column].right].left = column;
+    nodes[nodes[column].left].right = column;
+}
+
+void DlxSolver::hideRow(qint32 row)
+{
+    const qint32 first = firstRowNode + 4 * row;
+    for ( qint32 j = first; j < first + 4; j++ ) {
+        nodes[nodes[j].down].up = nodes[j].up;
+        nodes[nodes[j].up].down = nodes[j].down;
+        columnSize[nodes[j].column]--;
+    }
+}
+
+void DlxSolver::unhideRow(qint32 row)
+{
+    const qint32 first = firstRowNode + 4 * row;
+    for ( qint32 j = first + 3; j >= first; j-- ) {
+        columnSize[nodes[j].column]++;
+        nodes[nodes[j].down].up = j;
+        nodes[nodes[j].up].down = j;
+    }
+}
+
+bool DlxSolver::load(const Field& field)
+{
+    undo.clear( );
+    if ( field.getN( ) != N )
+        return false;
+
+    const quint16 cellsCount = N * N;
+    for ( quint16 idx = 0; idx < cellsCount; idx++ ) {
+        Cell::CPtr pCell = field.cellAt(idx);
+        if ( pCell->isResolved( ) )
+            continue;
+        for ( CellValue v = 1; v <= N; v++ ) {
+            if ( pCell->hasCandidate(v) )
+                continue;
+            const qint32 row = idx * N + v - 1;
+            hideRow(row);
+            undo.append(~row);
+        }
+    }
+
+    for ( quint16 idx = 0; idx < cellsCount; idx++ ) {
+        Cell::CPtr pCell = field.cellAt(idx);
+        if ( !pCell->isResolved( ) )
+            continue;
+        const qint32 first = firstRowNode + 4 * (idx * N + pCell->value( ) - 1);
+        for ( qint32 j = first; j < first + 4; j++ )
+            if ( isCovered(nodes[j].column) )
+                return false;
+        for ( qint32 j = first; j < first + 4; j++ ) {
+            cover(nodes[j].column);
+            undo.append(nodes[j].column);
+        }
+    }
+    return true;
+}
+
+void DlxSolver::unload( )
+{
+    while ( !undo.isEmpty( ) ) {
+        const qint32 op = undo.takeLast( );
+        if ( op >= 0 )
+            uncover(op);
+        else
+            unhideRow(~op);
+    }
+}
+
+void DlxSolver::search(quint64 limit)
+{
+    visited++;
+    if ( nodes[0].right == 0 ) {
+        if ( solutionsFound++ == 0 )
+            solution = partial;
+        return;
+    }
+
+    qint32 column = nodes[0].right;
+    for ( qint32 c = nodes[column].right; c != 0 && columnSize[column] > 1; c = nodes[c].right )
+        if ( columnSize[c] < columnSize[column] )
+            column = c;
+    if ( columnSize[column] == 0 )
+        return;
+
+    cover(column);
+    for ( qint32 r = nodes[column].down; r != column && solutionsFound < limit; r = nodes[r].down ) {
+        partial.append(rowOf(r));
+        for ( qint32 j = nodes[r].right; j != r; j = nodes[j].right )
+            cover(nodes[j].column);
+        search(limit);
+        for ( qint32 j = nodes[r].left; j != r; j = nodes[j].left )
+            uncover(nodes[j].column);
+        partial.removeLast( );
+    }
+    uncover(column);
+}
+
+bool DlxSolver::solve(Field& field)
+{
+    if ( countSolutions(field, 1) == 0 )
+        return false;
+    for ( qint32 row: std::as_const(solution) )
+        field.cellAt(static_cast<quint16>(row / N))->setValue(static_cast<CellValue>(row % N + 1));
+    return true;
+}
+
+quint64 DlxSolver::countSolutions(const Field& field, quint64 limit)
+{
+    visited        = 0;
+    solutionsFound = 0;
+    solution.clear( );
+    partial.clear( );
+    if ( load(field) && limit > 0 )
+        search(limit);
+    unload( );
+    return solutionsFound;
+}
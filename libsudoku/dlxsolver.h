@@ -0,0 +1,71 @@
+#ifndef DLXSOLVER_H
+#define DLXSOLVER_H
+
+#include <QVector>
+
+class Field;
+class Geometry;
+
+/*! \brief Dancing Links (Algorithm X) solver for the sudoku exact-cover problem
+ *
+ * Matrix rows are (cell, digit) placements, columns are the four constraints:
+ * each cell holds one digit and each row, column and square holds each digit once.
+ * The node arena is built once for a board size and reused for every puzzle: loading
+ * a Field covers its givens and hides eliminated candidates, and all of it is
+ * undone in reverse order afterwards, so the arena returns to the pristine matrix.
+ */
+class DlxSolver
+{
+    struct Node
+    {
+        qint32 left;
+        qint32 right;
+        qint32 up;
+        qint32 down;
+        qint32 column;
+    };
+
+    quint8          N {0};
+    qint32          columnsCount {0};
+    qint32          firstRowNode {0};
+    QVector<Node>   nodes;          // root, column headers, then 4 nodes per placement
+    QVector<qint32> columnSize;
+
+    QVector<qint32> undo;           // >= 0 covered column, < 0 hidden placement as ~row
+    QVector<qint32> partial;        // placements chosen by current search branch
+    QVector<qint32> solution;       // placements of the first solution found
+    quint64         solutionsFound {0};
+    quint64         visited {0};
+
+    void cover(qint32 column);
+    void uncover(qint32 column);
+    void hideRow(qint32 row);
+    void unhideRow(qint32 row);
+    qint32 rowOf(qint32 node) const { return (node - firstRowNode) / 4; }
+    bool   isCovered(qint32 column) const { return nodes[nodes[column].left].right != column; }
+
+    bool load(const Field& field);
+    void unload( );
+    void search(quint64 limit);
+
+public:
+    /*! \brief builds the matrix for boards of \a geometry */
+    explicit DlxSolver(const Geometry& geometry);
+
+    quint8 getN( ) const { return N; }
+
+    /*! \brief finds a solution respecting values and candidates of \a field and writes it back
+     * \return false if \a field has another size or no solution
+     */
+    bool solve(Field& field);
+
+    /*! \brief counts solutions of \a field, stopping once \a limit is reached
+     * \return number of solutions, at most \a limit; 0 if \a field has another size
+     */
+    quint64 countSolutions(const Field& field, quint64 limit = 2);
+
+    /*! \brief search nodes visited by the last solve() or countSolutions() call */
+    quint64 nodesVisited( ) const { return visited; }
+};
+
+#endif  // DLXSOLVER_H
@@ -1,5 +1,10 @@
 #include "field.h"
+#include "basicfield.h"
+#include "celltrail.h"
+#include "dlxsolver.h"
+#include "packedcorpus.h"
 
+#include <cstring>
 #include <iostream>
 #include <QFile>
 #include <QTextStream>
@@ -7,27 +12,88 @@
 
 Field::~Field( )
 {
-    for ( Cell::Ptr cell: cells )
-        cell->deleteLater( );
+    qDeleteAll(cells);
 }
 
 void Field::setN(quint8 n)
 {
+    if ( cellTrail )
+        cellTrail->clear( );
+    if ( n == N && geom.getN( ) == n ) {
+        clearValues( );
+        return;
+    }
+
+    // may throw for an unsupported size, leave the field untouched then
+    if ( geom.getN( ) != n )
+        geom = Geometry(n);
     N = n;
     cells.resize(n * n);
-    Coord::init(n);
-    House::init(n);
+    cellStates.resize(n * n);
+    planes.reset(n);
 
     for ( quint16 idx = 0; idx < n * n; idx++ ) {
         if ( !cells[idx] )
             cells[idx] = new Cell(n);
         Cell::Ptr pCell = cells[idx];
+        pCell->attachState(&cellStates[idx]);
+        pCell->attachPlanes(&planes);
+        pCell->attachObserver(cellObserver);
+        pCell->attachTrail(cellTrail);
         pCell->reset(n, idx);
     }
 
     prepareHouses(n);
 }
 
+void Field::clearValues( )
+{
+    planes.reset(N);
+    std::fill(cellStates.begin( ), cellStates.end( ), Cell::State {CandidateMask::all(N), 0, false});
+    if ( cellObserver ) {
+        for ( Cell::Ptr pCell: std::as_const(cells) ) {
+            cellObserver->valueRemoved(pCell);
+            cellObserver->candidatesReset(pCell);
+            cellObserver->cellReset(pCell);
+        }
+    }
+}
+
+void Field::setCellObserver(CellObserver* observer)
+{
+    cellObserver = observer;
+    for ( Cell::Ptr pCell: cells )
+        if ( pCell )
+            pCell->attachObserver(observer);
+}
+
+void Field::setTrail(CellTrail* trail)
+{
+    cellTrail = trail;
+    for ( Cell::Ptr pCell: cells )
+        if ( pCell )
+            pCell->attachTrail(trail);
+}
+
+void Field::saveState(Snapshot& snapshot) const
+{
+    snapshot.n = N;
+    snapshot.cells.resize(cellStates.size( ));
+    std::memcpy(snapshot.cells.data( ), cellStates.data( ), cellStates.size( ) * sizeof(Cell::State));
+    snapshot.planes.copyCandidates(planes);
+}
+
+bool Field::restoreState(const Snapshot& snapshot)
+{
+    if ( snapshot.n != N || snapshot.cells.size( ) != cellStates.size( ) )
+        return false;
+    std::memcpy(cellStates.data( ), snapshot.cells.data( ), cellStates.size( ) * sizeof(Cell::State));
+    planes.copyCandidates(snapshot.planes);
+    // techniques must not take the restored regions for ones they have seen already
+    planes.touchAll( );
+    return true;
+}
+
 bool Field::readFromFormattedTextFile(const QString& filename)
 {
     QFile inputFile(filename);
@@ -50,7 +116,7 @@ bool Field::readFromFormattedTextFile(const QString& filename)
         for ( quint8 col = 1; col <= n; col++ ) {
             if ( lines[row - 1][col - 1] != '.' ) {
                 CellValue v = static_cast<CellValue>(lines[row - 1][col - 1].digitValue( ));
-                cell(Coord(row, col))->setValue(v, true);
+                cell(Coord(row, col, n))->setValue(v, true);
             }
         }
     }
@@ -72,24 +138,88 @@ bool Field::readFromPlainTextFile(const QString& filename, int num)
         if ( !line.startsWith('#') )
             lines.append(line);
     } while ( !stream.atEnd( ) );
-    QString line = lines.at(qMin(num, lines.count( ) - 1));
-    auto    n    = static_cast<quint8>(qSqrt(line.length( )));
+    return readFromPlainText(lines.at(qMin(num, lines.count( ) - 1)));
+}
+
+bool Field::readFromPlainText(QStringView line)
+{
+    return readPlainTextLine(line);
+}
+
+bool Field::readFromPlainText(QLatin1String line)
+{
+    return readPlainTextLine(line);
+}
+
+template<class View>
+bool Field::readPlainTextLine(View line)
+{
+    const auto n = static_cast<quint8>(qSqrt(line.length( )));
+    if ( n * n != line.length( ) || !Geometry::isSupported(n) ) {
+        std::cerr << "wrong puzzle line length: " << line.length( ) << std::endl;
+        return false;
+    }
+    return loadGivens(n, [line] (quint16 idx) { return symbolValue(line[idx]); });
+}
+
+bool Field::readFromPacked(const uchar* packed, quint8 n)
+{
+    const quint8 bits = PackedCorpus::bitsPerCell(n);
+    return loadGivens(n, [packed, bits] (quint16 idx) { return PackedCorpus::unpack(packed, bits, idx); });
+}
+
+void Field::storePacked(uchar* packed, bool givensOnly) const
+{
+    const quint8 bits = PackedCorpus::bitsPerCell(N);
+    for ( quint16 idx = 0; idx < N * N; idx++ ) {
+        Cell::CPtr pCell = cells[idx];
+        if ( pCell->isResolved( ) && (!givensOnly || pCell->isInitialValue( )) )
+            PackedCorpus::pack(packed, bits, idx, pCell->value( ));
+    }
+}
+
+template<class Values>
+bool Field::loadGivens(quint8 n, Values valueAt)
+{
+    for ( quint16 idx = 0; idx < n * n; idx++ )
+        if ( valueAt(idx) > n ) {
+            std::cerr << "value out of range in puzzle: " << (int)valueAt(idx) << std::endl;
+            return false;
+        }
     setN(n);
 
-    for ( Coord coord = Coord::first( ); coord.isValid( ); coord++ ) {
-        QChar symbol = line[coord.rawIndex( )];
-        if ( symbol.isDigit( ) && symbol.toLatin1( ) != '0' )
-            cell(coord)->setValue(static_cast<CellValue>(symbol.digitValue( )), true);
-        else if ( symbol.isLetter( ) ) {
-            QString s(symbol);
-            quint8  v = s.toUShort(nullptr, 26);
-            cell(coord)->setValue(static_cast<CellValue>(v), true);
+    // fixed-size engine propagates givens; contradicting puzzles take the generic path
+    const bool loaded = withBasicField(n, [this, n, &valueAt] (auto& engine) {
+        engine.clear( );
+        for ( quint16 idx = 0; idx < n * n; idx++ ) {
+            const CellValue v = valueAt(idx);
+            if ( v && !engine.assign(idx, v) )
+                return false;
         }
+        engine.assignTo(*this);
+        return true;
+    });
+    if ( loaded )
+        return true;
+
+    for ( Coord coord = Coord::first(n); coord.isValid( ); coord++ ) {
+        CellValue v = valueAt(coord.rawIndex( ));
+        if ( v )
+            cell(coord)->setValue(v, true);
     }
 
     return true;
 }
 
+CellValue Field::symbolValue(QChar symbol)
+{
+    if ( symbol.isDigit( ) )
+        return static_cast<CellValue>(symbol.digitValue( ));
+    if ( symbol.isLetter( ) )
+        return static_cast<CellValue>(QString(symbol).toUShort(nullptr, 26));
+    return 0;
+}
+
 void Field::prepareHouses(quint8 n)
 {
     areas.clear( );
@@ -102,7 +232,7 @@ void Field::prepareHouses(quint8 n)
     rows.resize(n);
     squares.resize(n);
 
-    for ( Coord coord = Coord::first( ); coord.isValid( ); coord++ ) {
+    for ( Coord coord = Coord::first(n); coord.isValid( ); coord++ ) {
         Cell::Ptr c = cell(coord);
         c->registerInHouse(columns[coord.col( ) - 1]);
         c->registerInHouse(rows[coord.row( ) - 1]);
@@ -114,6 +244,10 @@ void Field::prepareHouses(quint8 n)
         rows[i - 1].setName(QString("R%1").arg(i));
         squares[i - 1].setName(QString("S%1").arg(i));
 
+        rows[i - 1].attachPlanes(&planes, i - 1);
+        columns[i - 1].attachPlanes(&planes, n + i - 1);
+        squares[i - 1].attachPlanes(&planes, 2 * n + i - 1);
+
         areas.append(&columns[i - 1]);
         areas.append(&rows[i - 1]);
         areas.append(&squares[i - 1]);
@@ -130,38 +264,28 @@ Cell::CPtr Field::cell(const Coord& coord) const
     return cells[coord.rawIndex( )];
 }
 
-CellSet Field::allCellsVisibleFromCell(Cell::CPtr c)
+CellSet Field::allCellsVisibleFromCell(Cell::CPtr c) const
 {
-    CellSet        visibleCells;
-    QVector<Coord> coords = c->coord( ).sameColumnCoordinates( );
-    for ( const Coord& co: coords ) {
-        Cell::Ptr cellToAdd = cell(co);
-        visibleCells.addCell(cellToAdd);
-    }
-
-    coords = c->coord( ).sameRowCoordinates( );
-    for ( const Coord& co: coords ) {
-        Cell::Ptr cellToAdd = cell(co);
-        if ( !visibleCells.hasCell(cellToAdd) )
-            visibleCells.addCell(cellToAdd);
-    }
-
-    coords = c->coord( ).sameSquareCoordinates( );
-    for ( const Coord& co: coords ) {
-        Cell::Ptr cellToAdd = cell(co);
-        if ( !visibleCells.hasCell(cellToAdd) )
-            visibleCells.addCell(cellToAdd);
-    }
-
+    CellSet visibleCells;
+    for ( quint16 idx: geom.peers(c->coord( ).rawIndex( )) )
+        visibleCells.addCell(cells[idx]);
     return visibleCells;
 }
 
-CellSet Field::allCellsVisibleFromBothCell(Cell::CPtr c1, Cell::CPtr c2)
+CellSet Field::allCellsVisibleFromBothCell(Cell::CPtr c1, Cell::CPtr c2) const
 {
-    CellSet vis1 = allCellsVisibleFromCell(c1);
-    CellSet vis2 = allCellsVisibleFromCell(c2);
+    CellSet visibleCells;
+    for ( quint16 idx: visibleFromBoth(c1, c2) )
+        visibleCells.addCell(cells[idx]);
+    return visibleCells;
+}
 
-    return vis1 / vis2;
+bool Field::removeCandidate(const CellBitSet& where, CellValue val)
+{
+    bool ret = false;
+    for ( quint16 idx: where & planes.digit(val) )
+        ret |= cells[idx]->removeCandidate(val);
+    return ret;
 }
 
 QVector<House::Ptr> Field::commonHouses(Cell::CPtr c1, Cell::CPtr c2)
@@ -206,6 +330,25 @@ bool Field::isValid( ) const
     });
 }
 
+SolutionCount Field::countSolutions(quint64 limit, QDeadlineTimer deadline) const
+{
+    SolutionCount result;
+    if ( !isValid( ) )
+        return result;
+    const bool counted = withBasicField(N, [this, &result, limit, deadline] (auto& engine) {
+        engine.load(*this);
+        result = engine.countSolutions(limit, deadline);
+        return true;
+    });
+    if ( !counted ) {
+        // no fixed-size engine for this size; exact cover has no deadline support
+        DlxSolver dlx(geom);
+        result.solutions = dlx.countSolutions(*this, limit);
+        result.nodes     = dlx.nodesVisited( );
+    }
+    return result;
+}
+
 quint8 Field::columnCount( ) const
 {
     return static_cast<quint8>(columns.count( ));
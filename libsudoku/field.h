@@ -1,12 +1,20 @@
 #ifndef FIELD_H
 #define FIELD_H
 
+#include "basicfield.h"
+#include "candidateplanes.h"
 #include "cell.h"
+#include "geometry.h"
 #include "house.h"
 #include "technique.h"
 
 #include <QVector>
 
+#include <algorithm>
+#include <vector>
+
+class CellTrail;
+
 
 class Field
 {
@@ -16,30 +24,119 @@ class Field
     QVector<SquareHouse> squares;
     QVector<House::Ptr> areas;
     QVector<Cell::Ptr> cells{nullptr};
+    std::vector<Cell::State> cellStates;  // cells point into it, so it must never be shared or moved
+    CandidatePlanes planes;
+    Geometry geom;
+    CellObserver* cellObserver{nullptr};
+    CellTrail* cellTrail{nullptr};
+
+    template<class View>
+    bool readPlainTextLine(View line);
+    /// setN(n), then places the givens valueAt(idx) returns, 0 for an empty cell; false for a value above n
+    template<class Values>
+    bool loadGivens(quint8 n, Values valueAt);
 public:
+    /// values and candidates of a whole board, see saveState()
+    struct Snapshot
+    {
+        quint8                   n{0};
+        std::vector<Cell::State> cells;
+        CandidatePlanes          planes;
+    };
+
     Field() = default;
     ~Field();
 
     quint8 getN() const {return N;}
+    /*! \brief empties the board for size \a n
+     *
+     * Cells and houses are only rebuilt when the size changes; otherwise it is
+     * clearValues(). The trail, if any, is cleared as well.
+     */
     void setN(quint8 n);
+    /*! \brief empties every cell keeping geometry, houses and attachments
+     *
+     * All candidates come back in one pass over the cell states; an attached observer
+     * is told about each cell as by Cell::reset().
+     */
+    void clearValues();
     void prepareHouses(quint8 n);
+    /*! \brief attaches \a observer to every cell, nullptr detaches; not owned */
+    void setCellObserver(CellObserver* observer);
+    CellObserver* getCellObserver() const { return cellObserver; }
+    /*! \brief makes every cell record its changes into \a trail, nullptr detaches; not owned */
+    void setTrail(CellTrail* trail);
+    CellTrail* trail() const { return cellTrail; }
+
+    /*! \brief copies values and candidates into \a snapshot, reusing its storage */
+    void saveState(Snapshot& snapshot) const;
+    /*! \brief puts back values and candidates saved by saveState()
+     *
+     * Two plain copies: the cell states and the candidate planes. Observers are not
+     * notified and the trail records nothing; every cell and house counts as changed.
+     * \return false if \a snapshot was taken from a board of another size
+     */
+    bool restoreState(const Snapshot& snapshot);
 
     bool readFromFormattedTextFile(const QString& filename);
     bool readFromPlainTextFile(const QString& filename, int num);
+    /*! \brief loads puzzle \a line: one symbol per cell, '.' or '0' for empty ones
+     * \return false if the line length is not the cell count of a supported board size
+     *         or a symbol stands for a value above it
+     */
+    bool readFromPlainText(QStringView line);
+    /*! \brief same for a view into 8-bit text, such as PuzzleCorpus::puzzle() */
+    bool readFromPlainText(QLatin1String line);
+    /*! \brief loads givens of a board of size \a n packed as in PackedCorpus
+     * \return false on a value above \a n
+     */
+    bool readFromPacked(const uchar* packed, quint8 n);
+    /*! \brief packs the values of the board into zeroed \a packed, see PackedCorpus
+     * \param givensOnly leave cells without an initial value empty
+     */
+    void storePacked(uchar* packed, bool givensOnly) const;
+    /*! \brief value of a puzzle file symbol: digits, then letters from A = 10; 0 for empty cell */
+    static CellValue symbolValue(QChar symbol);
 
     Cell::Ptr  cell(const Coord& coord);
     Cell::CPtr cell(const Coord& coord) const;
+    Cell::Ptr  cellAt(quint16 rawIndex) const { return cells[rawIndex]; }
 
-    CellSet allCellsVisibleFromCell(Cell::CPtr c) ;
-    CellSet allCellsVisibleFromBothCell(Cell::CPtr c1, Cell::CPtr c2);
+    const Geometry& geometry() const { return geom; }
+
+    CellSet allCellsVisibleFromCell(Cell::CPtr c) const;
+    CellSet allCellsVisibleFromBothCell(Cell::CPtr c1, Cell::CPtr c2) const;
+    /*! \brief peers of \a c as a bitset of raw indices, no allocation */
+    const CellBitSet& visibleFrom(Cell::CPtr c) const { return geom.peerMask(c->coord().rawIndex()); }
+    CellBitSet visibleFromBoth(Cell::CPtr c1, Cell::CPtr c2) const { return visibleFrom(c1) & visibleFrom(c2); }
+    bool sees(Cell::CPtr c1, Cell::CPtr c2) const { return geom.sees(c1->coord().rawIndex(), c2->coord().rawIndex()); }
+    /*! \brief removes \a val from every cell in \a where that still has it
+     * \return true if at least one candidate was removed
+     */
+    bool removeCandidate(const CellBitSet& where, CellValue val);
+
+    /*! \brief candidate combinations of size 2..min(N/2, \a maxSize), enumerated lazily */
+    CandidateCombinations candidatesCombinations(int maxSize) const { return CandidateCombinations(N, 2, static_cast<quint8>(std::clamp(maxSize, 0, N / 2))); }
     QVector<House::Ptr> commonHouses(Cell::CPtr c1, Cell::CPtr c2);
 
+    const CandidatePlanes& candidatePlanes() const { return planes; }
+    /*! \brief unresolved cells of \a house that still have \a val as a candidate */
+    CellBitSet candidatePositions(const CellSet& house, CellValue val) const { return planes.digit(val) & house.mask(); }
+
     void print(std::ostream& stream) const;
 
     bool isResolved() const;
     bool hasEmptyValues() const;
     bool isValid() const;
 
+    /*! \brief counts solutions that agree with current values and candidates, up to \a limit
+     *
+     * Uses singles propagation and search; the field itself is not changed. Candidates
+     * removed by techniques that assume uniqueness (Unique Rectangle) may hide solutions,
+     * so count on a freshly read field.
+     */
+    SolutionCount countSolutions(quint64 limit = 2, QDeadlineTimer deadline = QDeadlineTimer::Forever) const;
+
     quint8 columnCount() const;
     quint8 rowsCount() const;
 
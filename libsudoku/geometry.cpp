@@ -0,0 +1,78 @@
+#include "geometry.h"
+#include "coord.h"
+
+#include <stdexcept>
+
+bool Geometry::isSupported(quint8 n)
+{
+    const quint8 s = Coord::squareSizeFor(n);
+    return n >= 4 && s * s == n && n * n <= CellBitSet::MaxCells;
+}
+
+Geometry::Geometry(quint8 n) : n(n), boxSize(Coord::squareSizeFor(n))
+{
+    if ( !isSupported(n) )
+        throw std::out_of_range("unsupported field size");
+
+    const quint16 count = n * n;
+    peersPerCell        = 3 * n - 2 * boxSize - 1;
+
+    rowOf.resize(count);
+    columnOf.resize(count);
+    squareOf.resize(count);
+    rowMasks.resize(n);
+    columnMasks.resize(n);
+    squareMasks.resize(n);
+    rowTable.reserve(count);
+    columnTable.reserve(count);
+    squareTable.resize(count);
+
+    QVector<quint8> squareFill(n, 0);
+    for ( quint16 idx = 0; idx < count; idx++ ) {
+        const quint8 r = idx / n;
+        const quint8 c = idx % n;
+        const quint8 s = (r / boxSize) * boxSize + c / boxSize;
+        rowOf[idx]     = r;
+        columnOf[idx]  = c;
+        squareOf[idx]  = s;
+        rowMasks[r].set(idx);
+        columnMasks[c].set(idx);
+        squareMasks[s].set(idx);
+        squareTable[s * n + squareFill[s]++] = idx;
+        rowTable.append(idx);
+    }
+    for ( quint8 c = 0; c < n; c++ )
+        for ( quint8 r = 0; r < n; r++ )
+            columnTable.append(r * n + c);
+
+    peerMasks.resize(count);
+    peerTable.reserve(count * peersPerCell);
+    for ( quint16 idx = 0; idx < count; idx++ ) {
+        CellBitSet mask = rowMasks[rowOf[idx]] | columnMasks[columnOf[idx]] | squareMasks[squareOf[idx]];
+        mask.reset(idx);
+        peerMasks[idx] = mask;
+        for ( quint16 peer: mask )
+            peerTable.append(peer);
+    }
+
+    const quint32 house = static_cast<quint32>((quint64 {1} << n) - 1);
+    const quint32 band  = (quint32 {1} << boxSize) - 1;
+    intersectionTable.reserve(2 * n * boxSize);
+    for ( quint8 s = 0; s < n; s++ ) {
+        const quint8 firstRow = (s / boxSize) * boxSize;
+        const quint8 firstCol = (s % boxSize) * boxSize;
+        for ( quint8 k = 0; k < boxSize; k++ ) {
+            // square positions are row-major: a row is a run of boxSize bits, a column every boxSize-th bit
+            const quint32 rowInSquare = band << (k * boxSize);
+            const quint32 rowInLine   = band << firstCol;
+            intersectionTable.append({s, static_cast<quint8>(firstRow + k), true, rowInSquare, house & ~rowInSquare, rowInLine, house & ~rowInLine});
+        }
+        for ( quint8 k = 0; k < boxSize; k++ ) {
+            quint32 colInSquare = 0;
+            for ( quint8 r = 0; r < boxSize; r++ )
+                colInSquare |= quint32 {1} << (r * boxSize + k);
+            const quint32 colInLine = band << firstRow;
+            intersectionTable.append({s, static_cast<quint8>(firstCol + k), false, colInSquare, house & ~colInSquare, colInLine, house & ~colInLine});
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include "cellbitset.h"
+
+#include <QtCore/qglobal.h>
+#include <QVector>
+
+#include <span>
+
+/*! \brief Lookup tables describing a NxN board, built once per board size
+ *
+ * All cells are addressed by raw index (row-major, 0-based). Houses are numbered
+ * 0..N-1 within their kind, squares row-major. Peers of a cell are all other cells
+ * sharing a row, column or square with it, listed once in ascending index order.
+ */
+class Geometry
+{
+public:
+    /*! \brief segment where a square crosses a row or a column
+     *
+     * Masks are positions inside the house (bit k is the k-th cell of the house in
+     * index order), the same as House::candidatePositions(), so a check for a digit
+     * is an AND with the house's live positions.
+     */
+    struct Intersection
+    {
+        quint8  square;
+        quint8  line;  // row or column index
+        bool    isRow;
+        quint32 inSquare;
+        quint32 restOfSquare;
+        quint32 inLine;
+        quint32 restOfLine;
+    };
+
+private:
+    quint8 n {0};
+    quint8 boxSize {0};
+    quint8 peersPerCell {0};
+
+    QVector<quint8>     rowOf;
+    QVector<quint8>     columnOf;
+    QVector<quint8>     squareOf;
+    QVector<quint16>    peerTable;
+    QVector<CellBitSet> peerMasks;
+    QVector<quint16>    rowTable;
+    QVector<quint16>    columnTable;
+    QVector<quint16>    squareTable;
+    QVector<CellBitSet> rowMasks;
+    QVector<CellBitSet> columnMasks;
+    QVector<CellBitSet> squareMasks;
+
+    QVector<Intersection> intersectionTable;
+
+public:
+    Geometry( ) = default;
+    /// throws std::out_of_range unless isSupported(n)
+    explicit Geometry(quint8 n);
+
+    /// whether \a n is a board size with square boxes, 4 up to 25
+    static bool isSupported(quint8 n);
+
+    quint8 getN( ) const { return n; }
+
+    quint8 squareSize( ) const { return boxSize; }
+
+    quint16 cellsCount( ) const { return n * n; }
+
+    quint8 row(quint16 idx) const { return rowOf[idx]; }
+
+    quint8 column(quint16 idx) const { return columnOf[idx]; }
+
+    quint8 square(quint16 idx) const { return squareOf[idx]; }
+
+    std::span<const quint16> peers(quint16 idx) const { return {peerTable.constData( ) + idx * peersPerCell, peersPerCell}; }
+
+    const CellBitSet& peerMask(quint16 idx) const { return peerMasks[idx]; }
+
+    bool sees(quint16 a, quint16 b) const { return peerMasks[a].test(b); }
+
+    std::span<const quint16> rowCells(quint8 r) const { return {rowTable.constData( ) + r * n, n}; }
+
+    std::span<const quint16> columnCells(quint8 c) const { return {columnTable.constData( ) + c * n, n}; }
+
+    std::span<const quint16> squareCells(quint8 s) const { return {squareTable.constData( ) + s * n, n}; }
+
+    const CellBitSet& rowMask(quint8 r) const { return rowMasks[r]; }
+
+    const CellBitSet& columnMask(quint8 c) const { return columnMasks[c]; }
+
+    const CellBitSet& squareMask(quint8 s) const { return squareMasks[s]; }
+
+    /*! \brief all 2 * N * squareSize() square/line segments, square by square, rows before columns */
+    std::span<const Intersection> intersections( ) const { return {intersectionTable.constData( ), static_cast<size_t>(intersectionTable.count( ))}; }
+};
+
+#endif  // GEOMETRY_H
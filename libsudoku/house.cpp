@@ -3,28 +3,33 @@
 #include <iostream>
 #include <QVector>
 
-quint8 House::N = 0;
+#include <bit>
+#include <limits>
 
-void House::init(quint8 n)
+static bool byIndex(Cell::CPtr a, Cell::CPtr b)
 {
-    N = n;
+    return a->coord().rawIndex() < b->coord().rawIndex();
 }
 
 void CellSet::addCell(Cell::Ptr pCell)
 {
-    cells.append(pCell);
+    const quint16 idx = pCell->coord().rawIndex();
+    if (indices.test(idx))
+        return;
+    indices.set(idx);
+    if (cells.isEmpty() || byIndex(cells.last(), pCell))
+        cells.append(pCell);
+    else
+        cells.insert(std::lower_bound(cells.begin(), cells.end(), pCell, byIndex), pCell);
 }
 
 void CellSet::removeCell(Cell::Ptr pCell)
 {
-    if (cells.contains(pCell))
-        cells.removeOne(pCell);
-}
-
-
-House::House()
-{
-    cells.reserve(House::N);
+    const quint16 idx = pCell->coord().rawIndex();
+    if (!indices.test(idx))
+        return;
+    indices.reset(idx);
+    cells.erase(std::lower_bound(cells.begin(), cells.end(), pCell, byIndex));
 }
 
 void CellSet::print(std::ostream &stream) const
@@ -78,19 +83,49 @@ bool CellSet::hasUnresolvedCells() const
     });
 }
 
+void House::attachPlanes(const CandidatePlanes* planes, quint8 houseIdx)
+{
+    this->planes = planes;
+    planesIdx = houseIdx;
+}
+
+CandidatePlanes::HousePositions House::candidatePositions(CellValue val) const
+{
+    if (planes)
+        return planes->housePositions(planesIdx, val);
+
+    CandidatePlanes::HousePositions ret = 0;
+    for (int k = 0; k < cells.count(); k++)
+        if (!cells[k]->isResolved() && cells[k]->hasCandidate(val))
+            ret |= CandidatePlanes::HousePositions {1} << k;
+    return ret;
+}
+
+quint64 House::lastChange() const
+{
+    if (planes)
+        return planes->lastHouseChange(planesIdx);
+    return std::numeric_limits<quint64>::max();
+}
+
+int House::candidatesCount(CellValue val) const
+{
+    return std::popcount(candidatePositions(val));
+}
+
 bool House::isValid() const
 {
-    QBitArray mask(cells.count());
+    CandidateMask mask;
     for ( Cell::CPtr pCell: cells)
     {
 //        if (!pCell->isValid())
 //            return false; /// TODO: this check fails when reading from file since value might no be set yet and only 1 variant left
         if (!pCell->isResolved())
             continue;
-        quint8 bit = pCell->value()-1;
-        if (mask.testBit(bit))
+        CellValue val = pCell->value();
+        if (mask.hasCandidate(val))
             return false;
-        mask.setBit(bit, true);
+        mask.setCandidate(val);
     }
     return true;
 }
@@ -102,10 +137,7 @@ bool House::isResolved() const
 
 bool CellSet::hasCell(Cell::CPtr p) const
 {
-    return std::any_of(begin(), end(), [p](Cell::Ptr pCell)
-    {
-       return *pCell == *p;
-    });
+    return indices.test(p->coord().rawIndex());
 }
 
 CellSet CellSet::cellsWithCandidate(CellValue val) const
@@ -120,29 +152,45 @@ CellSet CellSet::cellsWithCandidate(CellValue val) const
 CellSet CellSet::operator+(const CellSet& a) const
 {
     CellSet ret;
-    for (Cell::Ptr cell: cells)
-        ret.addCell(cell);
-    for (Cell::Ptr cell: a.cells)
-        if (!ret.cells.contains(cell))
-            ret.addCell(cell);
+    ret.indices = indices | a.indices;
+    ret.cells.reserve(ret.indices.count());
+    // both lists are sorted, merge them skipping cells present in both
+    auto it = cells.cbegin();
+    auto itA = a.cells.cbegin();
+    while (it != cells.cend() || itA != a.cells.cend())
+    {
+        if (itA == a.cells.cend() || (it != cells.cend() && !byIndex(*itA, *it)))
+        {
+            if (itA != a.cells.cend() && *itA == *it)
+                ++itA;
+            ret.cells.append(*it++);
+        }
+        else
+            ret.cells.append(*itA++);
+    }
     return ret;
 }
 
 CellSet CellSet::operator-(const CellSet& a) const
 {
-    CellSet ret;
-    for(Cell::Ptr cell: cells)
-        if (!a.cells.contains(cell))
-            ret.addCell(cell);
-    return ret;
+    return filtered(indices - a.indices);
 }
 
 CellSet CellSet::operator/(const CellSet& a) const
+{
+    return filtered(indices & a.indices);
+}
+
+CellSet CellSet::filtered(const CellBitSet& subset) const
 {
     CellSet ret;
-    for(Cell::Ptr cell: cells)
-        if (a.cells.contains(cell))
-            ret.addCell(cell);
+    ret.indices = subset;
+    if (subset.isEmpty())
+        return ret;
+    ret.cells.reserve(subset.count());
+    for (Cell::Ptr cell: cells)
+        if (subset.test(cell->coord().rawIndex()))
+            ret.cells.append(cell);
     return ret;
 }
 
@@ -2,13 +2,28 @@
 #define AREA_H
 
 #include <QSet>
+#include <QVarLengthArray>
 #include "cell.h"
-
+#include "cellbitset.h"
+
+/*! \brief Set of cells, kept in raw index order
+ *
+ * Membership lives in a CellBitSet, so hasCell() is O(1) and the set algebra is done
+ * word-wise on the indices; the cell pointers are only a sorted list for iteration and
+ * indexing, filled in one linear pass. Both are stored inline for houses and for the
+ * peer sets of 9x9 and 16x16 (20 and 39 cells); 25x25 peer sets allocate.
+ */
 class CellSet
 {
     QString houseName;
+public:
+    using Cells = QVarLengthArray<Cell::Ptr, 40>;
 protected:
-    QVector<Cell::Ptr> cells;
+    Cells      cells;
+    CellBitSet indices;
+
+    /*! \brief cells of this set whose indices are in \a subset, which must be a subset of mask() */
+    CellSet filtered(const CellBitSet& subset) const;
 public:
     void addCell(Cell::Ptr pCell);
     void removeCell(Cell::Ptr pCell);
@@ -29,6 +44,8 @@ public:
 
     int count() const { return cells.count();}
     bool isEmpty() const { return cells.isEmpty();}
+    /*! \brief raw indices of the cells in the set */
+    const CellBitSet& mask() const { return indices;}
     Cell::Ptr const & operator[](int index) const {return cells[index];}
     Cell::Ptr &       operator[](int index)       {return cells[index];}
 
@@ -36,8 +53,8 @@ public:
     CellSet operator- (const CellSet& a) const;
     CellSet operator/ (const CellSet& a) const;
 
-    typedef typename QVector<Cell::Ptr>::iterator iterator;
-    typedef typename QVector<Cell::Ptr>::const_iterator const_iterator;
+    typedef typename Cells::iterator iterator;
+    typedef typename Cells::const_iterator const_iterator;
     inline iterator begin() { return cells.begin(); }
     inline const_iterator begin() const { return cells.constBegin(); }
     inline const_iterator cbegin() const { return cells.constBegin(); }
@@ -52,12 +69,25 @@ std::ostream& operator << (std::ostream& stream, const CellSet& cellset);
 
 class House : public CellSet
 {
-    static quint8 N;
+    const CandidatePlanes* planes {nullptr};
+    quint8 planesIdx {0};
 public:
     using Ptr = House*;
     using CPtr = const House*;
-    House();
-    static void init(quint8 n);
+
+    /*! \brief lets the house read its per-digit positions from \a planes instead of scanning cells
+     * \a houseIdx is the house number in \a planes numbering (rows, columns, squares)
+     */
+    void attachPlanes(const CandidatePlanes* planes, quint8 houseIdx);
+
+    /*! \brief bit k is set if k-th cell of the house is unresolved and has \a val as a candidate */
+    CandidatePlanes::HousePositions candidatePositions(CellValue val) const;
+    /*! \brief number of the latest change to a cell of the house, see CandidatePlanes::lastChange()
+     * Without attached planes the house counts as changed all the time.
+     */
+    quint64 lastChange() const;
+    /*! \brief number of unresolved cells that can still hold \a val, O(1) once planes are attached */
+    int candidatesCount(CellValue val) const;
 
     bool isValid() const;
     bool isResolved() const;
@@ -10,7 +10,7 @@ QT       -= gui
 TARGET = sudoku
 TEMPLATE = lib
 
-CONFIG += c++17 silent
+CONFIG += c++20 silent
 
 win32 {
 CONFIG += staticlib
@@ -18,9 +18,10 @@ CONFIG += staticlib
 
 DEFINES += SUDOKU_LIBRARY \
 		  _MT \
-		  _DELAY_SET_VALUE \
-		  _DELAY_TECHNIQUE_RUN \
-		  LOG_STREAM=std::clog
+		  SUDOKU_LOG_MAX_LEVEL=3
+
+# scalar 9x9 bitboard solver instead of SSE2
+#DEFINES += SUDOKU_NO_SIMD
 
 # The following define makes your compiler emit warnings if you use
 # any feature of Qt which has been marked as deprecated (the exact warnings
@@ -34,31 +35,54 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+		basicfield.cpp \
+		bitboardsolver.cpp \
+		candidateplanes.cpp \
 		coord.cpp \
 		cell.cpp \
+		celltrail.cpp \
 		house.cpp \
+		log.cpp \
 		bilocationlink.cpp \
 		cellcolor.cpp \
+		dlxsolver.cpp \
 		field.cpp \
+		geometry.cpp \
+		packedcorpus.cpp \
+		puzzlecorpus.cpp \
 		resolver.cpp \
+		solvetrace.cpp \
 		technique.cpp
 
 HEADERS += \
+		basicfield.h \
+		bitboardsolver.h \
+		candidatemask.h \
+		candidateplanes.h \
+		canceltoken.h \
+		cellbitset.h \
 		coord.h \
 		cell.h \
 		cellcolor.h \
+		celltrail.h \
+		dlxsolver.h \
 		house.h \
+		log.h \
+		observer.h \
+		packedcorpus.h \
 		bilocationlink.h \
 		field.h \
+		geometry.h \
 		libsudoku_global.h \
+		puzzlecorpus.h \
 		resolver.h \
+		solvetrace.h \
 		technique.h
 
 unix {
 	target.path = /usr/lib
 	INSTALLS += target
 
-	LIBS += -lgsl -lgslcblas
 	QMAKE_CXXFLAGS += -Wall -Wpedantic
 }
 
@@ -0,0 +1,58 @@
+#include "log.h"
+
+#include <iostream>
+
+std::atomic<Log::Level> Log::currentLevel {Log::Level::Summary};
+
+static std::ostream*              output       = &std::clog;
+static thread_local std::ostream* threadOutput = nullptr;
+
+void Log::setLevel(Level level)
+{
+    currentLevel.store(level, std::memory_order_relaxed);
+}
+
+Log::Level Log::level( )
+{
+    return currentLevel.load(std::memory_order_relaxed);
+}
+
+Log::Level Log::levelFromName(const QString& name, bool* ok)
+{
+    const QString lower = name.toLower( );
+    bool          found = true;
+    Level         ret   = Level::Summary;
+    if ( lower == "off" )
+        ret = Level::Off;
+    else if ( lower == "summary" )
+        ret = Level::Summary;
+    else if ( lower == "info" )
+        ret = Level::Info;
+    else if ( lower == "trace" )
+        ret = Level::Trace;
+    else
+        found = false;
+    if ( ok )
+        *ok = found;
+    return ret;
+}
+
+void Log::setStream(std::ostream& stream)
+{
+    output = &stream;
+}
+
+void Log::setThreadStream(std::ostream* stream)
+{
+    threadOutput = stream;
+}
+
+std::ostream* Log::threadStream( )
+{
+    return threadOutput;
+}
+
+std::ostream& Log::stream( )
+{
+    return threadOutput ? *threadOutput : *output;
+}
@@ -0,0 +1,59 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <QString>
+
+#include <atomic>
+#include <ostream>
+
+#ifndef SUDOKU_LOG_MAX_LEVEL
+    #define SUDOKU_LOG_MAX_LEVEL 3
+#endif
+
+/*! \brief Solver trace output with a runtime level and a compile-time ceiling
+ *
+ * Messages above SUDOKU_LOG_MAX_LEVEL are discarded by the compiler. Messages above
+ * the runtime level cost one relaxed load: the stream expression, and so formatting
+ * of its arguments, is not evaluated.
+ */
+namespace Log
+{
+enum class Level : quint8
+{
+    Off,
+    Summary,  //!< outcome of a solve
+    Info,     //!< technique findings
+    Trace,    //!< every value set and candidate removed
+};
+
+constexpr bool compiledIn(Level level) { return static_cast<int>(level) <= SUDOKU_LOG_MAX_LEVEL; }
+
+extern std::atomic<Level> currentLevel;
+
+inline bool enabled(Level level) { return level <= currentLevel.load(std::memory_order_relaxed); }
+
+void  setLevel(Level level);
+Level level( );
+
+/*! \brief "off", "summary", "info" or "trace"
+ * \return Level::Summary and \a ok set to false for anything else
+ */
+Level levelFromName(const QString& name, bool* ok = nullptr);
+
+/*! \brief messages go to \a stream, std::clog by default; not owned */
+void          setStream(std::ostream& stream);
+/*! \brief messages of the calling thread go to \a stream instead, nullptr switches back; not owned */
+void          setThreadStream(std::ostream* stream);
+/// stream set by setThreadStream() for the calling thread, nullptr if none
+std::ostream* threadStream( );
+std::ostream& stream( );
+}  // namespace Log
+
+/*! \brief stream for a message of \a level (Summary, Info or Trace), use as SUDOKU_LOG(Info) << ... << '\n'; */
+#define SUDOKU_LOG(level)                                    \
+    if constexpr ( !Log::compiledIn(Log::Level::level) ) { } \
+    else if ( !Log::enabled(Log::Level::level) ) { }         \
+    else                                                     \
+        Log::stream( )
+
+#endif  // LOG_H
@@ -0,0 +1,51 @@
+#ifndef OBSERVER_H
+#define OBSERVER_H
+
+#include "candidatemask.h"
+
+class Cell;
+class Technique;
+
+/*! \brief Opt-in notifications about cell changes
+ *
+ * Callbacks are invoked synchronously on the solving thread. Without an attached
+ * observer a cell only pays for a null pointer check.
+ */
+class CellObserver
+{
+public:
+    virtual ~CellObserver( ) = default;
+
+    virtual void valueAboutToBeSet(const Cell*, CellValue) { }
+
+    virtual void valueSet(const Cell*, CellValue) { }
+
+    virtual void valueRemoved(const Cell*) { }
+
+    virtual void candidatesAboutToBeRemoved(const Cell*, CandidateMask) { }
+
+    virtual void candidatesRemoved(const Cell*, CandidateMask) { }
+
+    virtual void candidatesReset(const Cell*) { }
+
+    virtual void cellReset(const Cell*) { }
+};
+
+/*! \brief Opt-in notifications about technique progress */
+class TechniqueObserver
+{
+public:
+    virtual ~TechniqueObserver( ) = default;
+
+    virtual void techniqueStarted(const Technique*) { }
+
+    virtual void techniqueDone(const Technique*) { }
+
+    virtual void techniqueApplied(const Technique*) { }
+
+    virtual void cellAnalyzeStarted(const Technique*, Cell*) { }
+
+    virtual void cellAnalyzeFinished(const Technique*, Cell*) { }
+};
+
+#endif  // OBSERVER_H
@@ -0,0 +1,233 @@
+#include "packedcorpus.h"
+#include "dlxsolver.h"
+#include "field.h"
+#include "puzzlecorpus.h"
+
+#include <QDataStream>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+
+static quint64 readLittleEndian(const uchar* bytes, int size)
+{
+    quint64 value = 0;
+    for ( int i = size - 1; i >= 0; i-- )
+        value = (value << 8) | bytes[i];
+    return value;
+}
+
+qsizetype PackedCorpus::recordSizeFor(quint8 n, quint8 contents)
+{
+    qsizetype size = cellsSize(n);
+    if ( contents & Solutions )
+        size += cellsSize(n);
+    if ( contents & Ratings )
+        size += sizeof(quint32);
+    return size;
+}
+
+CellValue PackedCorpus::unpack(const uchar* cells, quint8 bits, quint16 idx)
+{
+    const quint32 bit    = idx * bits;
+    const quint32 offset = bit % 8;
+    quint32       window = cells[bit / 8];
+    if ( offset + bits > 8 )
+        window |= quint32 {cells[bit / 8 + 1]} << 8;
+    return static_cast<CellValue>((window >> offset) & ((1u << bits) - 1));
+}
+
+void PackedCorpus::pack(uchar* cells, quint8 bits, quint16 idx, CellValue val)
+{
+    const quint32 bit    = idx * bits;
+    const quint32 offset = bit % 8;
+    const quint32 window = quint32 {val} << offset;
+    cells[bit / 8] |= static_cast<uchar>(window);
+    if ( offset + bits > 8 )
+        cells[bit / 8 + 1] |= static_cast<uchar>(window >> 8);
+}
+
+bool PackedCorpus::open(const QString& filename)
+{
+    close( );
+    file.setFileName(filename);
+    if ( !file.open(QFile::ReadOnly) )
+        return false;
+    const qint64 size = file.size( );
+    if ( size >= HeaderSize )
+        data = file.map(0, size);
+    if ( !data ) {
+        close( );
+        return false;
+    }
+
+    const quint32 magic   = static_cast<quint32>(readLittleEndian(data, 4));
+    const quint16 version = static_cast<quint16>(readLittleEndian(data + 4, 2));
+    n                     = data[6];
+    contents              = data[7];
+    const quint64 count   = readLittleEndian(data + 8, 8);
+    const quint32 width   = static_cast<quint32>(readLittleEndian(data + 16, 4));
+    recordSize            = recordSizeFor(n, contents);
+
+    const bool known = magic == Magic && version == Version && n >= 4 && n <= 25 && Coord::squareSizeFor(n) * Coord::squareSizeFor(n) == n
+                       && contents <= (Solutions | Ratings) && width == static_cast<quint32>(recordSize);
+    if ( !known || count > static_cast<quint64>((size - HeaderSize) / recordSize) ) {
+        close( );
+        return false;
+    }
+    records = static_cast<qsizetype>(count);
+    return true;
+}
+
+void PackedCorpus::close( )
+{
+    if ( data )
+        file.unmap(data);
+    data = nullptr;
+    file.close( );
+    n          = 0;
+    contents   = Givens;
+    records    = 0;
+    recordSize = 0;
+}
+
+bool PackedCorpus::loadPuzzle(qsizetype k, Field& field) const
+{
+    if ( k < 0 || k >= records )
+        return false;
+    return field.readFromPacked(data + HeaderSize + k * recordSize, n);
+}
+
+bool PackedCorpus::loadSolution(qsizetype k, Field& field) const
+{
+    if ( k < 0 || k >= records || !hasSolutions( ) )
+        return false;
+    return field.readFromPacked(data + HeaderSize + k * recordSize + cellsSize(n), n);
+}
+
+quint32 PackedCorpus::rating(qsizetype k) const
+{
+    if ( k < 0 || k >= records || !hasRatings( ) )
+        return 0;
+    return static_cast<quint32>(readLittleEndian(data + HeaderSize + (k + 1) * recordSize - sizeof(quint32), 4));
+}
+
+bool PackedCorpusWriter::open(const QString& filename, quint8 n, quint8 contents)
+{
+    close( );
+    file.setFileName(filename);
+    if ( !file.open(QFile::WriteOnly) )
+        return false;
+    this->n        = n;
+    this->contents = contents;
+    written        = 0;
+    record.resize(PackedCorpus::recordSizeFor(n, contents));
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << PackedCorpus::Magic << PackedCorpus::Version << n << contents << written
+           << static_cast<quint32>(record.count( )) << quint32 {0};
+    return stream.status( ) == QDataStream::Ok;
+}
+
+bool PackedCorpusWriter::append(const Field& puzzle, const Field* solution, quint32 rating)
+{
+    if ( !file.isOpen( ) || puzzle.getN( ) != n )
+        return false;
+    const bool withSolution = contents & PackedCorpus::Solutions;
+    if ( withSolution && (!solution || solution->getN( ) != n || !solution->isResolved( )) )
+        return false;
+
+    std::fill(record.begin( ), record.end( ), 0);
+    puzzle.storePacked(record.data( ), true);
+    if ( withSolution )
+        solution->storePacked(record.data( ) + PackedCorpus::cellsSize(n), false);
+    if ( contents & PackedCorpus::Ratings ) {
+        uchar* bytes = record.data( ) + record.count( ) - sizeof(quint32);
+        for ( int i = 0; i < 4; i++ )
+            bytes[i] = static_cast<uchar>(rating >> (8 * i));
+    }
+    if ( file.write(reinterpret_cast<const char*>(record.constData( )), record.count( )) != record.count( ) )
+        return false;
+    written++;
+    return true;
+}
+
+bool PackedCorpusWriter::close( )
+{
+    if ( !file.isOpen( ) )
+        return false;
+    bool ok = file.seek(8);
+    if ( ok ) {
+        QDataStream stream(&file);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream << written;
+        ok = stream.status( ) == QDataStream::Ok;
+    }
+    file.close( );
+    return ok;
+}
+
+qint64 PackedCorpusWriter::convert(const QString& source, const QString& target, quint8 contents)
+{
+    auto solve = [contents] (const Field& puzzle, Field& solution, quint32& rating) {
+        if ( !(contents & (PackedCorpus::Solutions | PackedCorpus::Ratings)) )
+            return true;
+        solution.setN(puzzle.getN( ));
+        for ( quint16 idx = 0; idx < puzzle.getN( ) * puzzle.getN( ); idx++ )
+            if ( puzzle.cellAt(idx)->isInitialValue( ) )
+                solution.cellAt(idx)->setValue(puzzle.cellAt(idx)->value( ), true);
+        DlxSolver dlx(solution.geometry( ));
+        if ( !dlx.solve(solution) )
+            return false;
+        rating = static_cast<quint32>(qMin<quint64>(dlx.nodesVisited( ), std::numeric_limits<quint32>::max( )));
+        return true;
+    };
+
+    Field              puzzle;
+    Field              solution;
+    quint32            rating = 0;
+    PackedCorpusWriter writer;
+    bool               created = false;  // only a target this call wrote to is removed on failure
+
+    auto create = [&] ( ) {
+        const bool opened = writer.open(target, puzzle.getN( ), contents);
+        created           = created || writer.isOpen( );
+        return opened;
+    };
+
+    auto convertAll = [&] ( ) {
+        if ( QFileInfo(source).suffix( ) == "fsdm" ) {
+            return puzzle.readFromFormattedTextFile(source) && solve(puzzle, solution, rating)
+                   && create( ) && writer.append(puzzle, &solution, rating);
+        }
+
+        PuzzleCorpus corpus;
+        if ( !corpus.open(source, false) || corpus.count( ) == 0 )
+            return false;
+        for ( qsizetype k = 0; k < corpus.count( ); k++ ) {
+            if ( !puzzle.readFromPlainText(corpus.puzzle(k)) || !solve(puzzle, solution, rating) )
+                return false;
+            if ( k == 0 && !create( ) )
+                return false;
+            if ( !writer.append(puzzle, &solution, rating) )
+                return false;
+        }
+        return true;
+    };
+
+    bool converted = false;
+    try {
+        converted = convertAll( ) && writer.close( );
+    } catch ( const std::exception& ) {
+        // a puzzle whose givens leave a cell without candidates makes Field throw
+    }
+    if ( converted )
+        return static_cast<qint64>(writer.count( ));
+    // no half-written corpus is left behind, and a file that was there before is kept
+    writer.close( );
+    if ( created )
+        QFile::remove(target);
+    return -1;
+}
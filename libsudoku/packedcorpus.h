@@ -0,0 +1,122 @@
+#ifndef PACKEDCORPUS_H
+#define PACKEDCORPUS_H
+
+#include "candidatemask.h"
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+#include <bit>
+
+class Field;
+
+/*! \brief Read access to a packed binary puzzle corpus
+ *
+ * The file starts with a 24 byte little-endian header: magic "SDPK", version, N,
+ * contents flags, record count and record size. Fixed-size records follow. A
+ * record holds the givens at bitsPerCell() bits per cell (4 for 9x9, 5 for 16x16
+ * and 25x25, 0 is an empty cell). Depending on the flags, it then holds the solution
+ * packed the same way and a 32-bit rating. The file is memory-mapped and Field
+ * reads records in place with Field::readFromPacked().
+ */
+class PackedCorpus
+{
+public:
+    enum Content : quint8
+    {
+        Givens    = 0,
+        Solutions = 1,  //!< every record also holds the solution
+        Ratings   = 2,  //!< every record ends with a rating, its meaning is up to the writer
+    };
+
+    static constexpr quint32 Magic      = 0x4B504453;  // "SDPK"
+    static constexpr quint16 Version    = 1;
+    static constexpr qint64  HeaderSize = 24;
+
+private:
+    QFile     file;
+    uchar*    data {nullptr};
+    quint8    n {0};
+    quint8    contents {Givens};
+    qsizetype records {0};
+    qsizetype recordSize {0};
+
+public:
+    PackedCorpus( ) = default;
+    PackedCorpus(const PackedCorpus&)            = delete;
+    PackedCorpus& operator= (const PackedCorpus&) = delete;
+    ~PackedCorpus( ) { close( ); }
+
+    /*! \brief maps \a filename and checks its header
+     * \return false if the file cannot be mapped, is not a packed corpus or is truncated
+     */
+    bool open(const QString& filename);
+    void close( );
+
+    bool isOpen( ) const { return data != nullptr; }
+
+    quint8    getN( ) const { return n; }
+    qsizetype count( ) const { return records; }
+    bool      hasSolutions( ) const { return contents & Solutions; }
+    bool      hasRatings( ) const { return contents & Ratings; }
+
+    /*! \brief loads the givens of puzzle \a k into \a field
+     * \return false if there is no such puzzle
+     */
+    bool loadPuzzle(qsizetype k, Field& field) const;
+    /*! \brief loads the solution of puzzle \a k into \a field, all values as givens
+     * \return false if there is no such puzzle or the corpus has no solutions
+     */
+    bool loadSolution(qsizetype k, Field& field) const;
+    /*! \brief rating of puzzle \a k, 0 without ratings */
+    quint32 rating(qsizetype k) const;
+
+    /// bits per packed cell: enough for values 0..n
+    static quint8 bitsPerCell(quint8 n) { return static_cast<quint8>(std::bit_width(static_cast<unsigned>(n))); }
+    /// bytes taken by the cells of one board
+    static qsizetype cellsSize(quint8 n) { return (n * n * bitsPerCell(n) + 7) / 8; }
+    static qsizetype recordSizeFor(quint8 n, quint8 contents);
+
+    static CellValue unpack(const uchar* cells, quint8 bits, quint16 idx);
+    /// \a cells must be zeroed beforehand
+    static void pack(uchar* cells, quint8 bits, quint16 idx, CellValue val);
+};
+
+/*! \brief Writes a packed corpus, see PackedCorpus for the layout */
+class PackedCorpusWriter
+{
+    QFile          file;
+    quint8         n {0};
+    quint8         contents {PackedCorpus::Givens};
+    quint64        written {0};
+    QVector<uchar> record;
+
+public:
+    ~PackedCorpusWriter( ) { close( ); }
+
+    /*! \brief creates \a filename for boards of size \a n with PackedCorpus::Content \a contents */
+    bool open(const QString& filename, quint8 n, quint8 contents);
+
+    /*! \brief appends a record: initial values of \a puzzle, all values of \a solution
+     * \return false if a board has another size or the corpus stores a solution and
+     *         \a solution is null or not resolved
+     */
+    bool append(const Field& puzzle, const Field* solution = nullptr, quint32 rating = 0);
+
+    /*! \brief writes the final record count into the header and closes the file */
+    bool close( );
+
+    quint64 count( ) const { return written; }
+    bool    isOpen( ) const { return file.isOpen( ); }
+
+    /*! \brief converts a plain text (.sdm) or formatted (.fsdm) puzzle file into a packed corpus
+     *
+     * With PackedCorpus::Solutions or Ratings every puzzle is solved by DlxSolver, which
+     * must find a solution; the rating is the number of search nodes it visited.
+     * \return number of puzzles written, -1 on failure
+     */
+    static qint64 convert(const QString& source, const QString& target, quint8 contents);
+};
+
+#endif  // PACKEDCORPUS_H
@@ -0,0 +1,121 @@
+#include "puzzlecorpus.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <cstring>
+
+static constexpr quint32 IndexMagic   = 0x58494453;  // "SDIX"
+static constexpr quint16 IndexVersion = 1;
+
+bool PuzzleCorpus::open(const QString& filename, bool useSidecar)
+{
+    close( );
+    file.setFileName(filename);
+    if ( !file.open(QFile::ReadOnly) )
+        return false;
+    size = file.size( );
+    if ( size > 0 )
+        data = file.map(0, size);
+    if ( !data ) {
+        close( );
+        return false;
+    }
+
+    const qint64 modified = QFileInfo(file).lastModified( ).toMSecsSinceEpoch( );
+    fromSidecar           = useSidecar && loadIndex(indexFileName(filename), modified);
+    if ( !fromSidecar ) {
+        scan( );
+        // a read-only directory only means scanning again next time
+        if ( useSidecar )
+            saveIndex(indexFileName(filename), modified);
+    }
+    return true;
+}
+
+void PuzzleCorpus::close( )
+{
+    if ( data )
+        file.unmap(data);
+    data = nullptr;
+    size = 0;
+    file.close( );
+    offsets.clear( );
+    fromSidecar = false;
+}
+
+QLatin1String PuzzleCorpus::puzzle(qsizetype k) const
+{
+    if ( k < 0 || k >= offsets.count( ) )
+        return { };
+    const char* text  = reinterpret_cast<const char*>(data);
+    const char* begin = text + offsets[k];
+    const char* end   = static_cast<const char*>(std::memchr(begin, '\n', static_cast<size_t>(text + size - begin)));
+    if ( !end )
+        end = text + size;
+    while ( end > begin && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t') )
+        end--;
+    return QLatin1String(begin, end - begin);
+}
+
+void PuzzleCorpus::scan( )
+{
+    offsets.clear( );
+    const char* text = reinterpret_cast<const char*>(data);
+    const char* end  = text + size;
+    for ( const char* line = text; line < end; ) {
+        const char* eol = static_cast<const char*>(std::memchr(line, '\n', static_cast<size_t>(end - line)));
+        if ( !eol )
+            eol = end;
+        const char* first = line;
+        while ( first < eol && (*first == ' ' || *first == '\t') )
+            first++;
+        if ( first < eol && *first != '#' && *first != '\r' )
+            offsets.append(static_cast<quint64>(first - text));
+        line = eol + 1;
+    }
+}
+
+bool PuzzleCorpus::loadIndex(const QString& filename, qint64 modified)
+{
+    QFile indexFile(filename);
+    if ( !indexFile.open(QFile::ReadOnly) )
+        return false;
+    QDataStream stream(&indexFile);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magic          = 0;
+    quint16 version        = 0;
+    qint64  sourceSize     = 0;
+    qint64  sourceModified = 0;
+    quint64 count          = 0;
+    stream >> magic >> version >> sourceSize >> sourceModified >> count;
+    if ( magic != IndexMagic || version != IndexVersion || sourceSize != size || sourceModified != modified
+         || count > static_cast<quint64>(size) )
+        return false;
+
+    offsets.resize(static_cast<qsizetype>(count));
+    for ( quint64& offset: offsets )
+        stream >> offset;
+    if ( stream.status( ) != QDataStream::Ok
+         || std::any_of(offsets.cbegin( ), offsets.cend( ), [this] (quint64 offset) { return offset >= static_cast<quint64>(size); }) ) {
+        offsets.clear( );
+        return false;
+    }
+    return true;
+}
+
+bool PuzzleCorpus::saveIndex(const QString& filename, qint64 modified) const
+{
+    QFile indexFile(filename);
+    if ( !indexFile.open(QFile::WriteOnly) )
+        return false;
+    QDataStream stream(&indexFile);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << IndexMagic << IndexVersion << size << modified << static_cast<quint64>(offsets.count( ));
+    for ( quint64 offset: offsets )
+        stream << offset;
+    return stream.status( ) == QDataStream::Ok;
+}
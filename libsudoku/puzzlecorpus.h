@@ -0,0 +1,60 @@
+#ifndef PUZZLECORPUS_H
+#define PUZZLECORPUS_H
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+/*! \brief Random access to the puzzles of a plain text corpus file
+ *
+ * The file is memory-mapped and a puzzle is returned as a view into the mapping, so
+ * nothing is copied until Field::readFromPlainText() parses it. Puzzles are the
+ * lines that are neither empty nor start with '#', numbered from 0; surrounding
+ * whitespace, CR included, is not part of the view.
+ *
+ * Line offsets are scanned once and kept in a sidecar index next to the file
+ * (indexFileName()); later opens only read the index, as long as the file size and
+ * modification time match. Without a writable directory the index lives in memory.
+ */
+class PuzzleCorpus
+{
+    QFile            file;
+    uchar*           data {nullptr};
+    qint64           size {0};
+    QVector<quint64> offsets;  // first symbol of every puzzle line
+    bool             fromSidecar {false};
+
+    void scan( );
+    bool loadIndex(const QString& filename, qint64 modified);
+    bool saveIndex(const QString& filename, qint64 modified) const;
+
+public:
+    PuzzleCorpus( ) = default;
+    PuzzleCorpus(const PuzzleCorpus&)            = delete;
+    PuzzleCorpus& operator= (const PuzzleCorpus&) = delete;
+    ~PuzzleCorpus( ) { close( ); }
+
+    /*! \brief maps \a filename and loads or builds its line index
+     * \param useSidecar read and write the index file; false keeps it in memory only
+     * \return false if the file cannot be opened or mapped, or is empty
+     */
+    bool open(const QString& filename, bool useSidecar = true);
+    void close( );
+
+    bool isOpen( ) const { return data != nullptr; }
+
+    qsizetype count( ) const { return offsets.count( ); }
+
+    /*! \brief puzzle \a k as a view into the mapped file, empty if there is no such puzzle
+     *
+     * The view stays valid until close().
+     */
+    QLatin1String puzzle(qsizetype k) const;
+
+    /// true if the last open() took the index from the sidecar instead of scanning
+    bool indexFromSidecar( ) const { return fromSidecar; }
+
+    static QString indexFileName(const QString& filename) { return filename + ".idx"; }
+};
+
+#endif  // PUZZLECORPUS_H
@@ -1,8 +1,14 @@
 #include "resolver.h"
+#include "basicfield.h"
+#include "dlxsolver.h"
 #include "field.h"
+#include "log.h"
+#include "solvetrace.h"
 
 #include <QElapsedTimer>
+#include <QThreadPool>
 
+#include <algorithm>
 #include <thread>
 #include <chrono>
 
@@ -12,8 +18,41 @@ Resolver::Resolver(Field& field, QObject *parent)
 
 Resolver::~Resolver()
 {
+    qDeleteAll(techniques);
+}
+
+void Resolver::setTechniqueObserver(TechniqueObserver* observer)
+{
+    techniqueObserver = observer;
+    for(Technique* tech: techniques)
+        tech->setObserver(observer);
+}
+
+void Resolver::setIncremental(bool incremental)
+{
+    this->incremental = incremental;
+    for(Technique* tech: techniques)
+        tech->setIncremental(incremental);
+}
+
+void Resolver::setBatch(bool batch)
+{
+    this->batch = batch;
+    for(Technique* tech: techniques)
+        tech->setBatch(batch);
+}
+
+void Resolver::setThreadCount(int count)
+{
+    threads = std::max(count, 1);
+    if (threads > 1)
+    {
+        if (!pool)
+            pool = new QThreadPool(this);
+        pool->setMaxThreadCount(threads);
+    }
     for(Technique* tech: techniques)
-        tech->deleteLater();
+        tech->setThreadPool(threads > 1 ? pool : nullptr);
 }
 
 quint64 Resolver::resolveTime() const
@@ -32,39 +71,148 @@ void Resolver::run()
     {
         emit done(elaps);
         emit resolved(elaps);
-        LOG_STREAM << "resolved" << std::endl;
+        SUDOKU_LOG(Summary) << "resolved" << '\n';
     }
     else if (!field.isValid())
     {
         emit done(elaps);
         emit failed(elaps);
-        LOG_STREAM << "is INVALID" << std::endl;
+        SUDOKU_LOG(Summary) << "is INVALID" << '\n';
+    }
+    else if (lastStats.timedOut)
+    {
+        emit done(elaps);
+        emit timedOut(elaps);
+        SUDOKU_LOG(Summary) << "timed out" << '\n';
     }
     else if (field.hasEmptyValues())
     {
         emit done(elaps);
         emit unresolved(elaps);
-        LOG_STREAM << "NOT resolved" << std::endl;
+        SUDOKU_LOG(Summary) << "NOT resolved" << '\n';
     }
 }
 
 void Resolver::process()
 {
     bool changed = false;
+    lastStats = Stats();
+    {
+        // a run begun by start() keeps a cancel() that came before its thread got here
+        QMutexLocker locker(&runLock);
+        if (!runScheduled)
+            cancelToken.clear();
+        runScheduled = false;
+        runActive    = true;
+    }
+    struct RunScope
+    {
+        Resolver* resolver;
+        ~RunScope() { QMutexLocker locker(&resolver->runLock); resolver->runActive = false; }
+    } runScope {this};
+    cancelToken.setDeadline(timeLimitMs >= 0 ? QDeadlineTimer(timeLimitMs) : QDeadlineTimer(QDeadlineTimer::Forever));
+    for(const Technique* tech: techniques)
+    {
+        lastStats.regionScans -= tech->regionScans();
+        lastStats.regionsSkipped -= tech->regionsSkipped();
+    }
+
+    struct TraceScope
+    {
+        SolveTrace* trace;
+        ~TraceScope() { if (trace) trace->end(); }
+    } traceScope {trace};
+    if (trace)
+        trace->begin(field, techniques, techniqueObserver);
 
     do
     {
         emit newIteration();
+        lastStats.iterations++;
         changed = false;
 
-        for(Technique* tech: techniques)
+        for(Technique* tech: runOrder())
         {
+            if (cancelToken.checkNow())
+                break;
             changed = tech->perform();
             if (changed)
+            {
+                lastStats.logicalSteps++;
                 break;
+            }
         }
-    }while(changed);
-    LOG_STREAM << "No more processing could be done" << std::endl;
+    }while(changed && !cancelToken.wasCancelled());
+    lastStats.timedOut = cancelToken.wasCancelled();
+    if (lastStats.timedOut)
+        SUDOKU_LOG(Summary) << "stopped after " << lastStats.iterations << " passes, " << lastStats.logicalSteps << " steps" << '\n';
+    else
+        SUDOKU_LOG(Info) << "No more processing could be done after " << lastStats.iterations << " passes" << '\n';
+
+    for(const Technique* tech: techniques)
+    {
+        lastStats.regionScans += tech->regionScans();
+        lastStats.regionsSkipped += tech->regionsSkipped();
+    }
+    SUDOKU_LOG(Info) << "Regions scanned " << lastStats.regionScans << ", skipped as unchanged " << lastStats.regionsSkipped << '\n';
+    for(const Technique* tech: techniques)
+        SUDOKU_LOG(Info) << qPrintable(tech->name()) << ": " << tech->runsCount() << " runs, " << tech->timeSpent() / 1000 << " us, "
+                         << tech->changesMade() << " changes" << '\n';
+
+    const quint16 cellsCount = field.getN() * field.getN();
+    for (quint16 idx = 0; idx < cellsCount; idx++)
+        if (!field.cellAt(idx)->isResolved())
+            lastStats.logicalUnresolved++;
+
+    if (searchEnabled && !lastStats.timedOut && lastStats.logicalUnresolved > 0 && field.isValid())
+        search();
+}
+
+void Resolver::search()
+{
+    lastStats.searched = true;
+    if (trace)
+        trace->searchStarted();
+    bool hasEngine = false;
+    bool found = withBasicField(field.getN(), [this, &hasEngine](auto& engine) {
+        hasEngine = true;
+        engine.load(field);
+        if (!engine.search(lastStats.searchNodes, &cancelToken))
+            return false;
+        engine.store(field);
+        return true;
+    });
+    if (!hasEngine)
+    {
+        // no fixed-size engine for this board size; DLX takes any, but cannot be cancelled
+        DlxSolver dlx(field.geometry());
+        found = dlx.solve(field);
+        lastStats.searchNodes = dlx.nodesVisited();
+    }
+    lastStats.timedOut = !found && cancelToken.wasCancelled();
+    SUDOKU_LOG(Summary) << "search: " << lastStats.logicalUnresolved << " cells left by techniques after "
+                        << lastStats.logicalSteps << " steps, " << lastStats.searchNodes << " nodes visited, "
+                        << (found ? "solution found" : lastStats.timedOut ? "stopped" : "no solution") << '\n';
+}
+
+QVector<Technique*> Resolver::runOrder() const
+{
+    if (schedulePolicy == Schedule::Fixed)
+        return techniques;
+
+    // changes per microsecond, smoothed so an untried technique looks promising
+    auto yield = [](const Technique* tech) {
+        return (tech->changesMade() + 1.0) / (tech->timeSpent() / 1000.0 + 1.0);
+    };
+    QVector<Technique*> order = techniques;
+    std::stable_sort(order.begin(), order.end(), [&yield](const Technique* a, const Technique* b) {
+        if (a->isCheap() != b->isCheap())
+            return a->isCheap();
+        if (a->isCheap())
+            return false;
+        return yield(a) > yield(b);
+    });
+    return order;
 }
 
 Technique *Resolver::technique(const QString &techName)
@@ -75,8 +223,29 @@ Technique *Resolver::technique(const QString &techName)
     return nullptr;
 }
 
+void Resolver::cancel()
+{
+    QMutexLocker locker(&runLock);
+    if (runScheduled || runActive)
+        cancelToken.cancel();
+}
+
+void Resolver::start(Priority priority)
+{
+    QMutexLocker locker(&runLock);
+    // as with QThread::start(), a thread that still runs is left alone
+    if (isRunning())
+        return;
+    cancelToken.clear();
+    runScheduled = true;
+    QThread::start(priority);
+}
+
 void Resolver::stop()
 {
     if (isRunning())
-        terminate();
+    {
+        cancel();
+        wait();
+    }
 }
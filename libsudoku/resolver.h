@@ -1,17 +1,63 @@
 #ifndef RESOLVER_H
 #define RESOLVER_H
 
+#include <QMutex>
 #include <QThread>
 #include <QVector>
 
+#include "canceltoken.h"
+#include "technique.h"
+
 class Field;
+class QThreadPool;
+class SolveTrace;
 class Technique;
+class TechniqueObserver;
 
 class Resolver : public QThread
 {
     Q_OBJECT
+public:
+    /// order in which process() tries techniques after each change
+    enum class Schedule
+    {
+        Fixed,    ///< registration order, results are reproducible
+        Adaptive  ///< cheap techniques first, the rest by changes made per microsecond so far
+    };
+
+    /// what the last process() call did
+    struct Stats
+    {
+        int     iterations {0};          ///< passes over the technique list, the last one changing nothing
+        int     logicalSteps {0};        ///< techniques applications that changed the field
+        int     logicalUnresolved {0};   ///< empty cells left when techniques stalled
+        bool    searched {false};        ///< search stage was run
+        quint64 searchNodes {0};         ///< nodes visited by search stage
+        quint64 regionScans {0};         ///< cells and houses examined by per-cell and per-house techniques
+        quint64 regionsSkipped {0};      ///< cells and houses skipped as unchanged
+        bool    timedOut {false};        ///< stopped by the time limit or cancel(), the field holds what was found so far
+    };
+
+private:
     Field&  field;
     quint64 elaps {0};
+    TechniqueObserver* techniqueObserver {nullptr};
+    SolveTrace*        trace {nullptr};
+    bool               searchEnabled {false};
+    bool               incremental {true};
+    bool               batch {false};
+    int                threads {1};
+    QThreadPool*       pool {nullptr};  // owned as child, created by setThreadCount()
+    CancelToken        cancelToken;
+    QMutex             runLock;            // guards the two flags below and cancel()
+    bool               runScheduled {false};  // start() was called, run() has not reached process() yet
+    bool               runActive {false};     // process() is running
+    qint64             timeLimitMs {-1};
+    Schedule           schedulePolicy {Schedule::Fixed};
+    Stats              lastStats;
+
+    void search( );
+    QVector<Technique*> runOrder( ) const;
 
 public:
     QVector<Technique*> techniques;  /// TODO: make in private
@@ -23,14 +69,72 @@ public:
     requires std::is_base_of_v<Technique, TECH>
     Technique* registerTechnique ( )
     {
-        Technique* tech = new TECH(field, true, this);
+        Technique* tech = new TECH(field, true);
+        tech->setObserver(techniqueObserver);
+        tech->setIncremental(incremental);
+        tech->setBatch(batch);
+        tech->setThreadPool(threads > 1 ? pool : nullptr);
+        tech->setCancelToken(&cancelToken);
         techniques.append(tech);
         return tech;
     }
 
+    /*! \brief attaches \a observer to all registered and future techniques; not owned */
+    void       setTechniqueObserver(TechniqueObserver* observer);
+    /*! \brief switches region skipping of all registered and future techniques, see Technique::setIncremental() */
+    void       setIncremental(bool incremental);
+    /*! \brief switches batch elimination of all registered and future techniques, see Technique::setBatch()
+     *
+     * Every productive technique run then applies everything it finds on the current
+     * state, so process() needs fewer passes. Steps recorded by a trace get coarser.
+     */
+    void       setBatch(bool batch);
+    /*! \brief runs per-cell, per-house and per-candidate techniques on \a count threads
+     *
+     * 1 (default) keeps everything on the calling thread. With more, workers of one pool kept
+     * for the resolver's lifetime compute eliminations from the unchanged field and the calling
+     * thread applies them, which implies batch elimination.
+     */
+    void       setThreadCount(int count);
+    int        threadCount( ) const { return threads; }
+    /*! \brief picks how techniques are ordered, Schedule::Fixed by default
+     *
+     * Adaptive ordering learns from every process() call of this resolver, so it pays
+     * off over many puzzles of one kind. Any order still tries every enabled technique
+     * before giving up; only which step is found first differs.
+     */
+    void       setSchedule(Schedule schedule) { schedulePolicy = schedule; }
+    Schedule   schedule( ) const { return schedulePolicy; }
+    /*! \brief makes every following process() record its steps into \a trace, nullptr stops; not owned */
+    void       setTrace(SolveTrace* trace) { this->trace = trace; }
+    /*! \brief enables backtracking search once techniques make no more progress
+     *
+     * Guarantees an answer for any valid puzzle, but the steps it makes are not
+     * explained by any technique. Disabled by default.
+     */
+    void       setSearchEnabled(bool enabled) { searchEnabled = enabled; }
+    bool       isSearchEnabled( ) const { return searchEnabled; }
+    /*! \brief bounds every following process() to \a msecs milliseconds, -1 (default) for no limit
+     *
+     * The limit is checked between techniques and inside their long loops, so a run
+     * overshoots by at most one loop step. A stopped run reports Stats::timedOut.
+     */
+    void       setTimeLimit(qint64 msecs) { timeLimitMs = msecs; }
+    qint64     timeLimit( ) const { return timeLimitMs; }
+    /*! \brief asks the current run to stop as with an expired time limit; safe from any thread
+     *
+     * A run lasts from start(), or from a direct process() call, until process() returns,
+     * so a cancel() right after start() stops that run even if its thread has not begun
+     * yet. A cancel() made while no run is in progress is dropped and never stops a later one.
+     */
+    void       cancel( );
     void       process( );
+    const Stats& stats( ) const { return lastStats; }
     Technique* technique(const QString& techName);
     // public slots:
+    /*! \brief runs process() on the resolver's thread; a cancel() from now on stops that run */
+    void start(Priority priority = InheritPriority);
+    /*! \brief cancels the running thread and waits for it; the field stays consistent */
     void stop( );
 
 protected:
@@ -40,6 +144,7 @@ signals:
     void resolved(quint64);
     void unresolved(quint64);
     void failed(quint64);
+    void timedOut(quint64);
     void newIteration( );
 };
 
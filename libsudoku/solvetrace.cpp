@@ -0,0 +1,333 @@
+#include "solvetrace.h"
+#include "cell.h"
+#include "field.h"
+#include "log.h"
+#include "technique.h"
+
+#include <QDataStream>
+#include <QFile>
+
+static constexpr quint32 TraceMagic   = 0x52544453;  // "SDTR"
+static constexpr quint16 TraceVersion = 2;
+
+void SolveTrace::begin(Field& field, const QVector<Technique*>& techniques, TechniqueObserver* next)
+{
+    clear( );
+    n = field.getN( );
+    for ( const Technique* tech: techniques )
+        names.append(tech->name( ));
+    for ( quint16 idx = 0; idx < n * n; idx++ ) {
+        Cell::CPtr pCell = field.cellAt(idx);
+        startValues.append(pCell->value( ));
+        startCandidates.append(static_cast<quint32>(pCell->candidatesMask( ).raw( )));
+    }
+
+    this->field           = &field;
+    this->techniques      = &techniques;
+    nextCellObserver      = field.getCellObserver( );
+    nextTechniqueObserver = next;
+    field.setCellObserver(this);
+    for ( Technique* tech: techniques )
+        tech->setObserver(this);
+}
+
+void SolveTrace::end( )
+{
+    if ( !field )
+        return;
+    stopCapture(false);
+    field->setCellObserver(nextCellObserver);
+    for ( Technique* tech: *techniques )
+        tech->setObserver(nextTechniqueObserver);
+    field      = nullptr;
+    techniques = nullptr;
+}
+
+void SolveTrace::clear( )
+{
+    n = 0;
+    names.clear( );
+    startValues.clear( );
+    startCandidates.clear( );
+    trace.clear( );
+    findings.clear( );
+    current  = NoTechnique;
+    stepOpen = false;
+    placing  = 0;
+}
+
+void SolveTrace::searchStarted( )
+{
+    current  = SearchStep;
+    stepOpen = false;
+}
+
+void SolveTrace::append(Kind kind, const Cell* cell, quint32 digits)
+{
+    if ( !stepOpen ) {
+        stepAt = trace.count( );
+        trace.append({Kind::Step, current, 0, 0});
+        stepOpen = true;
+    }
+    trace.append({kind, current, cell->coord( ).rawIndex( ), digits});
+}
+
+void SolveTrace::startCapture( )
+{
+    if ( capturing || !Log::enabled(Log::Level::Info) )
+        return;
+    finding.str(std::string( ));
+    findingNext = Log::threadStream( );
+    Log::setThreadStream(&finding);
+    capturing = true;
+}
+
+void SolveTrace::stopCapture(bool keep)
+{
+    if ( !capturing )
+        return;
+    Log::setThreadStream(findingNext);
+    capturing = false;
+    const std::string text = finding.str( );
+    if ( text.empty( ) )
+        return;
+    Log::stream( ) << text;
+    if ( !keep || !stepOpen )
+        return;
+    // Trace level messages ("\t...\n") describe the changes replay renders itself,
+    // a technique may emit them halfway through its own line
+    std::string explanation;
+    for ( size_t pos = 0; pos < text.size( ); ) {
+        if ( text[pos] == '\t' ) {
+            const size_t eol = text.find('\n', pos);
+            pos              = eol == std::string::npos ? text.size( ) : eol + 1;
+            continue;
+        }
+        explanation += text[pos++];
+    }
+    if ( explanation.empty( ) )
+        return;
+    findings.append(QString::fromStdString(explanation));
+    trace[stepAt].digits = static_cast<quint32>(findings.count( ));
+}
+
+bool SolveTrace::save(const QString& filename) const
+{
+    QFile file(filename);
+    if ( !file.open(QFile::WriteOnly) )
+        return false;
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << TraceMagic << TraceVersion << n << static_cast<quint8>(names.count( ));
+    for ( const QString& name: names )
+        stream << name;
+    for ( int idx = 0; idx < startValues.count( ); idx++ )
+        stream << startValues[idx] << startCandidates[idx];
+    stream << static_cast<quint32>(findings.count( ));
+    for ( const QString& text: findings )
+        stream << text;
+    stream << static_cast<quint32>(trace.count( ));
+    for ( const Record& record: trace )
+        stream << static_cast<quint8>(record.kind) << record.technique << record.cell << record.digits;
+    return stream.status( ) == QDataStream::Ok;
+}
+
+bool SolveTrace::load(const QString& filename)
+{
+    clear( );
+    QFile file(filename);
+    if ( !file.open(QFile::ReadOnly) )
+        return false;
+    if ( !read(file) ) {
+        clear( );
+        return false;
+    }
+    return true;
+}
+
+bool SolveTrace::read(QFile& file)
+{
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magic   = 0;
+    quint16 version = 0;
+    quint8  count   = 0;
+    stream >> magic >> version >> n >> count;
+    if ( stream.status( ) != QDataStream::Ok || magic != TraceMagic || version != TraceVersion )
+        return false;
+    if ( n != 9 && n != 16 && n != 25 )
+        return false;
+    for ( quint8 i = 0; i < count; i++ ) {
+        QString name;
+        stream >> name;
+        names.append(name);
+    }
+    startValues.resize(n * n);
+    startCandidates.resize(n * n);
+    const CandidateMask all = CandidateMask::all(n);
+    for ( int idx = 0; idx < n * n; idx++ ) {
+        stream >> startValues[idx] >> startCandidates[idx];
+        if ( startValues[idx] > n || !CandidateMask::fromRaw(startCandidates[idx]).isSubsetOf(all) )
+            return false;
+    }
+
+    quint32 findingsCount = 0;
+    stream >> findingsCount;
+    // a string takes at least its 4 byte length
+    if ( stream.status( ) != QDataStream::Ok || findingsCount > (file.size( ) - file.pos( )) / 4 )
+        return false;
+    for ( quint32 i = 0; i < findingsCount; i++ ) {
+        QString text;
+        stream >> text;
+        findings.append(text);
+    }
+
+    quint32 records = 0;
+    stream >> records;
+    // every record takes kind, technique, cell and digits: 8 bytes in the file
+    if ( stream.status( ) != QDataStream::Ok || records > (file.size( ) - file.pos( )) / 8 )
+        return false;
+    trace.resize(records);
+    for ( Record& record: trace ) {
+        quint8 kind = 0;
+        stream >> kind >> record.technique >> record.cell >> record.digits;
+        if ( kind > static_cast<quint8>(Kind::Eliminated) )
+            return false;
+        if ( kind == static_cast<quint8>(Kind::Step) && record.digits > static_cast<quint32>(findings.count( )) )
+            return false;
+        record.kind = static_cast<Kind>(kind);
+    }
+    return stream.status( ) == QDataStream::Ok;
+}
+
+bool SolveTrace::replay(Field& field, std::ostream& out) const
+{
+    field.setN(n);
+    for ( quint16 idx = 0; idx < n * n; idx++ )
+        field.cellAt(idx)->assignState(startValues[idx], CandidateMask::fromRaw(startCandidates[idx]), startValues[idx] != 0);
+
+    for ( const Record& record: trace ) {
+        if ( record.kind == Kind::Step ) {
+            if ( record.technique < names.count( ) )
+                out << qPrintable(names[record.technique]) << '\n';
+            else
+                out << (record.technique == SearchStep ? "(search)" : "(no technique)") << '\n';
+            if ( record.digits > 0 && record.digits <= static_cast<quint32>(findings.count( )) )
+                out << qPrintable(findings[record.digits - 1]);
+            continue;
+        }
+        if ( record.cell >= n * n )
+            return false;
+        Cell::Ptr pCell = field.cellAt(record.cell);
+        if ( record.kind == Kind::Placed ) {
+            if ( record.digits == 0 || record.digits > n )
+                return false;
+            const CellValue val = static_cast<CellValue>(record.digits);
+            if ( pCell->isResolved( ) || !pCell->hasCandidate(val) )
+                return false;
+            // placing it must not take the last candidate of a peer
+            for ( quint16 peer: field.geometry( ).peers(record.cell) ) {
+                Cell::CPtr pPeer = field.cellAt(peer);
+                if ( !pPeer->isResolved( ) && pPeer->candidatesMask( ) == CandidateMask::single(val) )
+                    return false;
+            }
+            out << "\tvalue " << (int)val << " set into " << pCell->coord( ) << '\n';
+            pCell->setValue(val);
+        } else {
+            const CandidateMask removed = CandidateMask::fromRaw(record.digits);
+            // a record that empties a cell is a contradiction, not a step
+            if ( pCell->candidatesMask( ).isSubsetOf(removed) )
+                return false;
+            out << "\tcandidates " << removed << " removed from " << pCell->coord( ) << '\n';
+            if ( !pCell->removeCandidate(removed) )
+                return false;
+        }
+    }
+    return true;
+}
+
+void SolveTrace::valueAboutToBeSet(const Cell* cell, CellValue val)
+{
+    if ( placing++ == 0 )
+        append(Kind::Placed, cell, val);
+    if ( nextCellObserver )
+        nextCellObserver->valueAboutToBeSet(cell, val);
+}
+
+void SolveTrace::valueSet(const Cell* cell, CellValue val)
+{
+    if ( placing > 0 )
+        placing--;
+    if ( nextCellObserver )
+        nextCellObserver->valueSet(cell, val);
+}
+
+void SolveTrace::valueRemoved(const Cell* cell)
+{
+    if ( nextCellObserver )
+        nextCellObserver->valueRemoved(cell);
+}
+
+void SolveTrace::candidatesAboutToBeRemoved(const Cell* cell, CandidateMask mask)
+{
+    if ( nextCellObserver )
+        nextCellObserver->candidatesAboutToBeRemoved(cell, mask);
+}
+
+void SolveTrace::candidatesRemoved(const Cell* cell, CandidateMask mask)
+{
+    // removals while a value is being placed follow from the placement
+    if ( placing == 0 )
+        append(Kind::Eliminated, cell, static_cast<quint32>(mask.raw( )));
+    if ( nextCellObserver )
+        nextCellObserver->candidatesRemoved(cell, mask);
+}
+
+void SolveTrace::candidatesReset(const Cell* cell)
+{
+    if ( nextCellObserver )
+        nextCellObserver->candidatesReset(cell);
+}
+
+void SolveTrace::cellReset(const Cell* cell)
+{
+    if ( nextCellObserver )
+        nextCellObserver->cellReset(cell);
+}
+
+void SolveTrace::techniqueStarted(const Technique* technique)
+{
+    const int idx = techniques ? techniques->indexOf(const_cast<Technique*>(technique)) : -1;
+    current       = idx < 0 ? NoTechnique : static_cast<quint8>(idx);
+    stepOpen      = false;
+    startCapture( );
+    if ( nextTechniqueObserver )
+        nextTechniqueObserver->techniqueStarted(technique);
+}
+
+void SolveTrace::techniqueDone(const Technique* technique)
+{
+    stopCapture(false);
+    if ( nextTechniqueObserver )
+        nextTechniqueObserver->techniqueDone(technique);
+}
+
+void SolveTrace::techniqueApplied(const Technique* technique)
+{
+    stopCapture(true);
+    if ( nextTechniqueObserver )
+        nextTechniqueObserver->techniqueApplied(technique);
+}
+
+void SolveTrace::cellAnalyzeStarted(const Technique* technique, Cell* cell)
+{
+    if ( nextTechniqueObserver )
+        nextTechniqueObserver->cellAnalyzeStarted(technique, cell);
+}
+
+void SolveTrace::cellAnalyzeFinished(const Technique* technique, Cell* cell)
+{
+    if ( nextTechniqueObserver )
+        nextTechniqueObserver->cellAnalyzeFinished(technique, cell);
+}
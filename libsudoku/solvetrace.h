@@ -0,0 +1,122 @@
+#ifndef SOLVETRACE_H
+#define SOLVETRACE_H
+
+#include "observer.h"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <ostream>
+#include <sstream>
+
+class Field;
+class QFile;
+class Technique;
+
+/*! \brief Compact binary record of a solve: which technique placed or eliminated what
+ *
+ * While attached to a Resolver it stores one fixed-size Record per change made by a
+ * technique itself; eliminations implied by placing a value are not stored, replay
+ * makes them again. The trace starts with a snapshot of the field, so it can be
+ * saved, loaded and replayed onto a fresh Field, rendering the steps as text.
+ *
+ * With the log level at Log::Level::Info or above, the explanation a technique logs
+ * for a step is kept as well and replay prints it under the step. It still reaches
+ * the log.
+ */
+class SolveTrace : public CellObserver, public TechniqueObserver
+{
+public:
+    enum class Kind : quint8
+    {
+        Step,        //!< a technique starts changing the field, digits holds its finding number, 0 for none
+        Placed,      //!< digits holds the value
+        Eliminated,  //!< digits holds the removed candidates mask
+    };
+
+    struct Record
+    {
+        Kind    kind;
+        quint8  technique;  // index in techniqueNames(), SearchStep or NoTechnique
+        quint16 cell;       // raw index
+        quint32 digits;
+    };
+
+    static constexpr quint8 NoTechnique = 0xFF;
+    static constexpr quint8 SearchStep  = 0xFE;  //!< changes made by the search after the techniques gave up
+
+private:
+    quint8             n {0};
+    QStringList        names;
+    QVector<CellValue> startValues;
+    QVector<quint32>   startCandidates;
+    QVector<Record>    trace;
+    QStringList        findings;
+
+    Field*                     field {nullptr};
+    const QVector<Technique*>* techniques {nullptr};
+    CellObserver*              nextCellObserver {nullptr};
+    TechniqueObserver*         nextTechniqueObserver {nullptr};
+    quint8                     current {NoTechnique};
+    bool                       stepOpen {false};
+    qsizetype                  stepAt {0};
+    int                        placing {0};
+    std::ostringstream         finding;
+    std::ostream*              findingNext {nullptr};
+    bool                       capturing {false};
+
+    void append(Kind kind, const Cell* cell, quint32 digits);
+    /// takes the solving thread's log output until stopCapture()
+    void startCapture( );
+    /// gives the log back and forwards what was taken; \a keep attaches it to the open step
+    void stopCapture(bool keep);
+    bool read(QFile& file);
+
+public:
+    /*! \brief takes a snapshot of \a field and starts recording; calls are forwarded to \a next observer */
+    void begin(Field& field, const QVector<Technique*>& techniques, TechniqueObserver* next);
+    /*! \brief stops recording and gives the observers back */
+    void end( );
+    void clear( );
+    /*! \brief credits the following changes to the search instead of the last technique */
+    void searchStarted( );
+
+    quint8 getN( ) const { return n; }
+
+    const QStringList& techniqueNames( ) const { return names; }
+
+    const QVector<Record>& records( ) const { return trace; }
+
+    /// technique explanations, a Step record refers to them by 1-based number
+    const QStringList& techniqueFindings( ) const { return findings; }
+
+    bool save(const QString& filename) const;
+    /*! \brief reads a trace written by save()
+     * \return false, leaving the trace empty, if the file is unreadable, truncated or not a trace
+     */
+    bool load(const QString& filename);
+
+    /*! \brief loads the snapshot into \a field and re-applies every record, writing a line per record to \a out
+     * \return false if a record does not fit the field state
+     */
+    bool replay(Field& field, std::ostream& out) const;
+
+    void valueAboutToBeSet(const Cell* cell, CellValue val) override;
+    void valueSet(const Cell* cell, CellValue val) override;
+    void valueRemoved(const Cell* cell) override;
+    void candidatesAboutToBeRemoved(const Cell* cell, CandidateMask mask) override;
+    void candidatesRemoved(const Cell* cell, CandidateMask mask) override;
+    void candidatesReset(const Cell* cell) override;
+    void cellReset(const Cell* cell) override;
+
+    void techniqueStarted(const Technique* technique) override;
+    void techniqueDone(const Technique* technique) override;
+    void techniqueApplied(const Technique* technique) override;
+    void cellAnalyzeStarted(const Technique* technique, Cell* cell) override;
+    void cellAnalyzeFinished(const Technique* technique, Cell* cell) override;
+};
+
+static_assert(sizeof(SolveTrace::Record) == 8, "trace records are meant to stay compact");
+
+#endif  // SOLVETRACE_H
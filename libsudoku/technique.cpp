@@ -1,103 +1,204 @@
 #include "technique.h"
 
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QtConcurrent>
 #include <QMap>
 #include <QSet>
 #include <QVector>
 
+#include <bit>
+
+#include "basicfield.h"
 #include "cell.h"
 #include "cellcolor.h"
 #include "coord.h"
 #include "field.h"
 #include "house.h"
+#include "log.h"
 
-// #define DELAY_TECHNIQUE_RUN
+Technique::Technique(Field& field, const QString& name, bool enabled) : techniqueName(name), enabled(enabled), N(field.getN( )), field(field)
+{
+}
 
-QSet<QBitArray> Technique::allCandidatesCombinationsMasks;
+void Technique::setEnabled(bool enabled)
+{
+    this->enabled = enabled;
+}
 
-#ifdef Q_OS_WIN
-void Technique::fillCandidatesCombinationsMasks(quint8 n)
+thread_local Technique::Batch* Technique::workerBatch = nullptr;
+
+bool Technique::perform( )
 {
-    allCandidatesCombinationsMasks.clear( );
-    QSet<QBitArray> array;
+    if ( !enabled )
+        return false;
+    N = field.getN( );
+    if ( observer )
+        observer->techniqueStarted(this);
+    if ( collectsAll( ) )
+        pending.clear(cells( ).count( ));
+    const quint64 changesBefore = field.candidatePlanes( ).lastChange( );
+    QElapsedTimer timer;
+    timer.start( );
+    bool res = run( );
+    // techniques writing the field on their own queue nothing, their answer stands
+    if ( !pending.cells.isEmpty( ) )
+        res = applyBatch( );
+    spentNs += timer.nsecsElapsed( );
+    changes += field.candidatePlanes( ).lastChange( ) - changesBefore;
+    runs++;
+    if ( observer ) {
+        if ( res )
+            observer->techniqueApplied(this);
+        else
+            observer->techniqueDone(this);
+    }
+    return res;
+}
 
-    for ( quint8 bit = 0; bit < n - 1; bit++ )
-        for ( quint8 bit2 = bit + 1; bit2 < n; bit2++ ) {
-            QBitArray a(n);
-            a.setBit(bit);
-            a.setBit(bit2);
-            array.insert(a);
-        }
+bool Technique::eliminate(Cell::Ptr pCell, CandidateMask mask)
+{
+    if ( workerBatch )
+        return workerBatch->eliminate(pCell, mask);
+    if ( collectsAll( ) )
+        return pending.eliminate(pCell, mask);
+    return pCell->removeCandidate(mask);
+}
 
-    for ( size_t k = 3; k <= n / 2; k++ ) {
-        QSet<QBitArray> b_array;
-        for ( const QBitArray& a: array ) {
-            for ( quint8 bit = 0; bit < n; bit++ ) {
-                QBitArray b = a;
-                b.setBit(bit);
-                b_array.insert(b);
-            }
-        }
-        array = b_array;
+bool Technique::eliminate(const CellBitSet& where, CellValue value)
+{
+    if ( !collectsAll( ) )
+        return field.removeCandidate(where, value);
+    bool ret = false;
+    for ( quint16 idx: where & field.candidatePlanes( ).digit(value) )
+        ret |= eliminate(cells( )[idx], CandidateMask::single(value));
+    return ret;
+}
+
+bool Technique::place(Cell::Ptr pCell, CellValue value)
+{
+    if ( workerBatch )
+        return workerBatch->place(pCell, value);
+    if ( collectsAll( ) )
+        return pending.place(pCell, value);
+    pCell->setValue(value);
+    return true;
+}
+
+void Technique::countScan(bool skipped)
+{
+    quint64& counter = skipped ? (workerBatch ? workerBatch->skips : skips) : (workerBatch ? workerBatch->scans : scans);
+    counter++;
+}
+
+void Technique::Batch::clear(qsizetype cellsCount)
+{
+    if ( values.count( ) != cellsCount ) {
+        removals.fill(CandidateMask( ), cellsCount);
+        values.fill(0, cellsCount);
+        cells.clear( );
     }
-    allCandidatesCombinationsMasks = array;
-}
-#else
-    #include <gsl/gsl_combination.h>
-
-void Technique::fillCandidatesCombinationsMasks(quint8 n)
-{
-    allCandidatesCombinationsMasks.clear( );
-    gsl_combination* c = nullptr;
-    QBitArray        testMask(n);
-    for ( size_t k = 2; k <= n / 2; k++ ) {
-        c = gsl_combination_calloc(n, k);
-        do {
-            testMask.fill(false);
-            size_t* comb_data = gsl_combination_data(c);
-            for ( size_t m = 0; m < gsl_combination_k(c); m++ ) {
-                size_t bit = comb_data[m];
-                testMask.setBit(bit);
-            }
-            allCandidatesCombinationsMasks.insert(testMask);
-        } while ( gsl_combination_next(c) == GSL_SUCCESS );
-        gsl_combination_free(c);
+    for ( quint16 idx: std::as_const(cells) ) {
+        removals[idx] = CandidateMask( );
+        values[idx]   = 0;
     }
+    cells.clear( );
+    scans = 0;
+    skips = 0;
+    log.str(std::string( ));
 }
-#endif
 
-Technique::Technique(Field& field, const QString& name, bool enabled, QObject* parent) : QObject(parent), techniqueName(name), enabled(enabled), N(field.getN( )), field(field)
+bool Technique::Batch::eliminate(Cell::CPtr pCell, CandidateMask mask)
 {
-    if ( Technique::allCandidatesCombinationsMasks.isEmpty( ) )
-        fillCandidatesCombinationsMasks(N);
+    if ( pCell->isResolved( ) )
+        return false;
+    const quint16       idx   = pCell->coord( ).rawIndex( );
+    const CandidateMask fresh = pCell->candidatesMask( ) & mask & ~removals[idx];
+    if ( fresh.isEmpty( ) )
+        return false;
+    if ( removals[idx].isEmpty( ) && !values[idx] )
+        cells.append(idx);
+    removals[idx] |= fresh;
+    return true;
 }
 
-void Technique::setEnabled(bool enabled)
+bool Technique::Batch::place(Cell::CPtr pCell, CellValue value)
 {
-    this->enabled = enabled;
+    const quint16 idx = pCell->coord( ).rawIndex( );
+    if ( pCell->isResolved( ) || values[idx] == value )
+        return false;
+    if ( removals[idx].isEmpty( ) && !values[idx] )
+        cells.append(idx);
+    if ( values[idx] )
+        // two values for one cell: drop them all, applying reports the contradiction
+        removals[idx] |= pCell->candidatesMask( );
+    else
+        values[idx] = value;
+    return true;
 }
 
-bool Technique::perform( )
+bool Technique::applyBatch( )
 {
-    if ( !enabled )
-        return false;
-    emit started( );
-#ifdef DELAY_TECHNIQUE_RUN
-    {
-        using namespace std::chrono_literals;
-        auto t0 = std::chrono::steady_clock::now( ) + 100ms;
-<<<<<<< HEAD
-        // std::this_thread::sleep_until (t0);
-=======
-        std::this_thread::sleep_until(t0);
->>>>>>> 9c8621a539c4b2047cfa7b05998d44d2e4cc6ace
+    bool changed = false;
+    // values first: they clear their peers, so removals queued there find less to do
+    for ( quint16 idx: std::as_const(pending.cells) ) {
+        const CellValue value = pending.values[idx];
+        Cell::Ptr       pCell = cells( )[idx];
+        if ( value && !pending.removals[idx].hasCandidate(value) && !pCell->isResolved( ) ) {
+            pCell->setValue(value);
+            changed = true;
+        }
     }
-#endif
-    bool res = run( );
-    if ( res )
-        emit applied( );
-    else
-        emit done( );
-    return res;
+    for ( quint16 idx: std::as_const(pending.cells) )
+        if ( !pending.removals[idx].isEmpty( ) )
+            changed |= cells( )[idx]->removeCandidate(pending.removals[idx]);
+    SUDOKU_LOG(Info) << qPrintable(name( )) << " applied batch of " << pending.cells.count( ) << " cells" << '\n';
+    pending.clear(cells( ).count( ));
+    return changed;
+}
+
+bool Technique::runParallel(int count, const std::function<bool(int)>& scan)
+{
+    // a few chunks per thread even out regions of different cost; chunks are contiguous,
+    // so merging them in order keeps the region order of a serial run
+    const int chunksCount = std::min(count, 4 * pool->maxThreadCount( ));
+    if ( workerBatches.size( ) != static_cast<size_t>(chunksCount) )
+        workerBatches = std::vector<Batch>(chunksCount);
+    std::vector<char> found(chunksCount, 0);
+    QVector<int>      chunks(chunksCount);
+    for ( int k = 0; k < chunksCount; k++ )
+        chunks[k] = k;
+
+    const qsizetype cellsCount = cells( ).count( );
+    QtConcurrent::blockingMap(pool, chunks, [&] (int k) {
+        Batch& own = workerBatches[k];
+        own.clear(cellsCount);
+        workerBatch = &own;
+        Log::setThreadStream(&own.log);
+        for ( int i = k * count / chunksCount; i < (k + 1) * count / chunksCount; i++ )
+            if ( scan(i) )
+                found[k] = 1;
+        Log::setThreadStream(nullptr);
+        workerBatch = nullptr;
+    });
+
+    bool ret = false;
+    for ( int k = 0; k < chunksCount; k++ ) {
+        Batch& own = workerBatches[k];
+        for ( quint16 idx: std::as_const(own.cells) ) {
+            Cell::Ptr pCell = cells( )[idx];
+            if ( own.values[idx] )
+                pending.place(pCell, own.values[idx]);
+            if ( !own.removals[idx].isEmpty( ) )
+                pending.eliminate(pCell, own.removals[idx]);
+        }
+        scans += own.scans;
+        skips += own.skips;
+        if ( own.log.tellp( ) > 0 )
+            Log::stream( ) << own.log.str( );
+        ret |= found[k] != 0;
+    }
+    return ret;
 }
 
 QVector<House::Ptr>& Technique::areas( )
@@ -130,7 +231,7 @@ Cell::Ptr Technique::cell(const Coord& c)
     return field.cell(c);
 }
 
-NakedSingleTechnique::NakedSingleTechnique(Field& field, bool enabled, QObject* parent) : PerCellTechnique(field, "Naked Single", enabled, parent)
+NakedSingleTechnique::NakedSingleTechnique(Field& field, bool enabled) : PerCellTechnique(field, "Naked Single", enabled)
 {
 }
 
@@ -138,13 +239,9 @@ bool NakedSingleTechnique::runPerCell(Cell::Ptr pCell)
 {
     bool changed = false;
     if ( !pCell->isResolved( ) && pCell->candidatesCount( ) == 1 ) {
-        for ( CellValue j = 1; j <= pCell->candidatesCapacity( ); j++ )
-            if ( pCell->hasCandidate(j) ) {
-                LOG_STREAM << "Naked single " << (int)j << " found in " << pCell->coord( ) << std::endl;
-                pCell->setValue(j);
-                changed = true;
-                break;
-            }
+        CellValue j = pCell->candidatesMask( ).first( );
+        SUDOKU_LOG(Info) << "Naked single " << (int)j << " found in " << pCell->coord( ) << '\n';
+        changed = place(pCell, j);
     }
     return changed;
 }
@@ -155,69 +252,83 @@ void NakedSingleTechnique::setEnabled(bool enabled)
     Technique::setEnabled(true);
 }
 
+FastSinglesTechnique::FastSinglesTechnique(Field& field, bool enabled) : Technique(field, "Fast Singles", enabled)
+{
+}
+
+bool FastSinglesTechnique::run( )
+{
+    return withBasicField(N, [this] (auto& engine) {
+        engine.load(field);
+        if ( !engine.propagateSingles( ) )
+            return false;
+        int changed = engine.store(field);
+        SUDOKU_LOG(Info) << "Fast singles changed " << changed << " cells" << '\n';
+        return changed > 0;
+    });
+}
+
 bool HiddenSingleTechnique::runPerHouse(House* house)
 {
-    bool            newValueSet = false;
-    QVector<quint8> valuesCount(N, 0);
-    for ( Cell* cell: *house ) {
-        if ( !cell->isResolved( ) ) {
-            for ( quint8 bit = 1; bit <= cell->candidatesCapacity( ); bit++ )
-                if ( cell->hasCandidate(bit) )
-                    valuesCount[bit - 1]++;
-        }
-    }
-    for ( CellValue bit = 1; bit <= valuesCount.count( ) && !newValueSet; bit++ ) {
-        if ( valuesCount[bit - 1] == 1 ) {
-            for ( Cell* pCell: *house ) {
-                if ( pCell->hasCandidate(bit) ) {
-                    LOG_STREAM << "Hidden single " << (int)bit << " found in " << pCell->coord( ) << std::endl;
-                    pCell->setValue(bit);
-                    newValueSet = true;
-                    break;
-                }
-            }
+    bool changed = false;
+    for ( CellValue bit = 1; bit <= N; bit++ ) {
+        const auto positions = house->candidatePositions(bit);
+        if ( std::has_single_bit(positions) ) {
+            Cell::Ptr pCell = (*house)[std::countr_zero(positions)];
+            SUDOKU_LOG(Info) << "Hidden single " << (int)bit << " found in " << pCell->coord( ) << '\n';
+            changed |= place(pCell, bit);
+            if ( !collectsAll( ) )
+                return changed;
         }
     }
-    return newValueSet;
+    return changed;
 }
 
-HiddenSingleTechnique::HiddenSingleTechnique(Field& field, bool enabled, QObject* parent) : PerHouseTechnique(field, "Hidden Single", enabled, parent)
+HiddenSingleTechnique::HiddenSingleTechnique(Field& field, bool enabled) : PerHouseTechnique(field, "Hidden Single", enabled)
 {
 }
 
 bool NakedGroupTechnique::runPerHouse(House* house)
 {
-    bool ret = false;
-    for ( const QBitArray& testMask: allCandidatesCombinationsMasks ) {
+    bool ret        = false;
+    int  unresolved = house->unresolvedCellsCount( );
+    // a group as big as all unresolved cells of the house tells nothing
+    for ( CandidateMask testMask: field.candidatesCombinations(unresolved - 1) ) {
+        if ( isCancelled( ) )
+            break;
+        const int      testCount = testMask.count( );
         QVector<Cell*> indices;
         for ( Cell* pCell: *house )
             if ( pCell->candidatesExactMatch(testMask) && !pCell->isResolved( ) )
                 indices.append(pCell);
-        if ( indices.count( ) == testMask.count(true) && house->unresolvedCellsCount( ) > indices.count( ) ) {
-            LOG_STREAM << "Naked combination " << testMask << " found in ";
+        if ( indices.count( ) == testCount ) {
+            SUDOKU_LOG(Info) << "Naked combination " << testMask << " found in ";
             for ( Cell* pCell: indices )
-                LOG_STREAM << pCell->coord( );
-            LOG_STREAM << std::endl;
+                SUDOKU_LOG(Info) << pCell->coord( );
+            SUDOKU_LOG(Info) << '\n';
             for ( Cell* pCell: *house )
                 if ( !indices.contains(pCell) && !pCell->isResolved( ) )
-                    ret |= pCell->removeCandidate(testMask);
-            if ( ret )
+                    ret |= eliminate(pCell, testMask);
+            if ( ret && !collectsAll( ) )
                 break;
         }
     }
     return ret;
 }
 
-NakedGroupTechnique::NakedGroupTechnique(Field& field, bool enabled, QObject* parent) : PerHouseTechnique(field, "Naked Group", enabled, parent)
+NakedGroupTechnique::NakedGroupTechnique(Field& field, bool enabled) : PerHouseTechnique(field, "Naked Group", enabled)
 {
 }
 
 bool HiddenGroupTechnique::runPerHouse(House* house)
 {
-    bool ret = false;
-    for ( const QBitArray& testMask: allCandidatesCombinationsMasks ) {
-        if ( testMask.count(true) == house->unresolvedCellsCount( ) )
-            continue;
+    bool ret        = false;
+    int  unresolved = house->unresolvedCellsCount( );
+    // hidden group can not be bigger than unresolved cells count, and equal one tells nothing
+    for ( CandidateMask testMask: field.candidatesCombinations(unresolved - 1) ) {
+        if ( isCancelled( ) )
+            break;
+        const int      testCount = testMask.count( );
         QVector<Cell*> indices;
         for ( Cell* pCell: *house ) {
             int candidatesInCell = pCell->hasAnyOfCandidates(testMask);
@@ -228,93 +339,97 @@ bool HiddenGroupTechnique::runPerHouse(House* house)
             if ( candidatesInCell > 1 && !pCell->isResolved( ) )
                 indices.append(pCell);
         }
-        if ( indices.count( ) == testMask.count(true) ) {
-            LOG_STREAM << "Hidden combination " << testMask << " found in ";
+        if ( indices.count( ) == testCount ) {
+            SUDOKU_LOG(Info) << "Hidden combination " << testMask << " found in ";
             for ( Cell* pCell: indices ) {
-                LOG_STREAM << pCell->coord( );
-                ret |= pCell->removeCandidate(~testMask);
+                SUDOKU_LOG(Info) << pCell->coord( );
+                ret |= eliminate(pCell, ~testMask);
             }
-            LOG_STREAM << std::endl;
-            if ( ret )
+            SUDOKU_LOG(Info) << '\n';
+            if ( ret && !collectsAll( ) )
                 return true;
         }
     }
     return ret;
 }
 
-HiddenGroupTechnique::HiddenGroupTechnique(Field& field, bool enabled, QObject* parent) : PerHouseTechnique(field, "Hidden Group", enabled, parent)
+HiddenGroupTechnique::HiddenGroupTechnique(Field& field, bool enabled) : PerHouseTechnique(field, "Hidden Group", enabled)
 {
 }
 
-#ifdef MT
-    #include <QtConcurrent>
-#endif
 bool PerHouseTechnique::run( )
 {
-#ifdef MT
-    return QtConcurrent::blockingFilteredReduced<bool>(
-        areas( ),
-        [this] (House* area) {
-        return runPerHouse(area);
-    },
-        [] (bool& result, const bool& intermediate) {
-        result |= intermediate;
-    });
-#else
+    const bool           skipClean = incremental && scope( ) == Scope::Region;
+    QVector<House::Ptr>& houses    = areas( );
+    if ( cleanBefore.count( ) != houses.count( ) )
+        cleanBefore.fill(0, houses.count( ));
+
+    auto scan = [&] (int i) {
+        if ( skipClean && houses[i]->lastChange( ) < cleanBefore[i] ) {
+            countScan(true);
+            return false;
+        }
+        if ( isCancelled( ) )
+            return false;
+        countScan(false);
+        const quint64 changesBefore = field.candidatePlanes( ).lastChange( );
+        if ( runPerHouse(houses[i]) )
+            return true;
+        // a house left half way is not clean
+        if ( !isCancelled( ) )
+            cleanBefore[i] = changesBefore + 1;
+        return false;
+    };
+    if ( pool )
+        return runParallel(houses.count( ), scan);
+
     bool newValuesSet = false;
-    for ( House* area: areas( ) ) {
-        newValuesSet = runPerHouse(area);
-        if ( newValuesSet )
-            break;
-    }
+    for ( int i = 0; i < houses.count( ) && !(newValuesSet && !collectsAll( )) && !isCancelled( ); i++ )
+        newValuesSet |= scan(i);
     return newValuesSet;
-#endif
 }
 
-IntersectionsTechnique::IntersectionsTechnique(Field& field, bool enabled, QObject* parent) : Technique(field, "Intersections", enabled, parent)
+IntersectionsTechnique::IntersectionsTechnique(Field& field, bool enabled) : Technique(field, "Intersections", enabled)
 {
 }
 
 bool IntersectionsTechnique::run( )
 {
     bool changed = false;
-    for ( SquareHouse& sq: squares( ) ) {
-        for ( LineHouse& r: rows( ) )
-            changed |= reduceIntersection(sq, r);
-        for ( LineHouse& c: columns( ) )
-            changed |= reduceIntersection(sq, c);
+    for ( const Geometry::Intersection& segment: field.geometry( ).intersections( ) ) {
+        LineHouse& line = segment.isRow ? static_cast<LineHouse&>(rows( )[segment.line]) : static_cast<LineHouse&>(columns( )[segment.line]);
+        changed |= reduceIntersection(squares( )[segment.square], line, segment);
     }
     return changed;
 }
 
-bool IntersectionsTechnique::reduceIntersection(SquareHouse& square, LineHouse& area)
+bool IntersectionsTechnique::reduceIntersection(SquareHouse& square, LineHouse& line, const Geometry::Intersection& segment)
 {
-    bool    changed      = false;
-    CellSet inter        = square / area;
-    CellSet squareNoLine = square - area;
-    CellSet lineNoSquare = area - square;
-
-    if ( inter.isEmpty( ) )
-        return false;
-
+    bool changed = false;
     for ( CellValue v = 1; v <= N; v++ ) {
-        if ( inter.candidatesCount(v) > 1 ) {
-            if ( squareNoLine.candidatesCount(v) == 0 && lineNoSquare.candidatesCount(v) != 0 ) {
-                LOG_STREAM << (int)v << " found in " << qPrintable(square.name( )) << " and " << qPrintable(area.name( )) << " intersection but no in any other cell of " << qPrintable(square.name( ))
-                           << std::endl;
-                changed |= lineNoSquare.removeCandidate(v);
-            }
-            if ( lineNoSquare.candidatesCount(v) == 0 && squareNoLine.candidatesCount(v) != 0 ) {
-                LOG_STREAM << (int)v << " found in " << qPrintable(square.name( )) << " and " << qPrintable(area.name( )) << " intersection but no in any other cell of " << qPrintable(area.name( ))
-                           << std::endl;
-                changed |= squareNoLine.removeCandidate(v);
-            }
+        const quint32 inSquare = square.candidatePositions(v);
+        if ( std::popcount(inSquare & segment.inSquare) < 2 )
+            continue;
+        quint32 restOfSquare = inSquare & segment.restOfSquare;
+        quint32 restOfLine   = line.candidatePositions(v) & segment.restOfLine;
+        if ( !restOfSquare && restOfLine ) {
+            // pointing: inside the square the digit is confined to the segment
+            SUDOKU_LOG(Info) << (int)v << " found in " << qPrintable(square.name( )) << " and " << qPrintable(line.name( )) << " intersection but no in any other cell of " << qPrintable(square.name( ))
+                       << '\n';
+            for ( ; restOfLine; restOfLine &= restOfLine - 1 )
+                changed |= eliminate(line[std::countr_zero(restOfLine)], CandidateMask::single(v));
+        } else if ( !restOfLine && restOfSquare ) {
+            // claiming: inside the line the digit is confined to the segment
+            SUDOKU_LOG(Info) << (int)v << " found in " << qPrintable(square.name( )) << " and " << qPrintable(line.name( )) << " intersection but no in any other cell of " << qPrintable(line.name( ))
+                       << '\n';
+            for ( ; restOfSquare; restOfSquare &= restOfSquare - 1 )
+                changed |= eliminate(square[std::countr_zero(restOfSquare)], CandidateMask::single(v));
         }
     }
     return changed;
 }
 
-BiLocationColoringTechnique::BiLocationColoringTechnique(Field& field, bool enabled, QObject* parent) : PerCandidateTechnique(field, "Bi-Location Coloring", enabled, parent)
+BiLocationColoringTechnique::BiLocationColoringTechnique(Field& field, bool enabled) : PerCandidateTechnique(field, "Bi-Location Coloring", enabled)
 {
 }
 
@@ -329,42 +444,47 @@ bool BiLocationColoringTechnique::runPerCandidate(CellValue candidate)
         CellColor c2 = vault.getColor(link.second( ));
 
         if ( c1 == ColorPair::UnknownColor && c2 == ColorPair::UnknownColor ) {
-            ColorPair cp = ColorPair::newPair( );
+            ColorPair cp = vault.newPair( );
             vault.addLink(link, cp);
         } else {
             if ( c1 == ColorPair::UnknownColor )
-                vault.addCell(link.first( ), ColorPair::antiColor(c2));
+                vault.addCell(link.first( ), vault.antiColor(c2));
             else if ( c2 == ColorPair::UnknownColor )
-                vault.addCell(link.second( ), ColorPair::antiColor(c1));
-            else if ( c1 != ColorPair::antiColor(c2) ) {
-                vault.recolor(ColorPair::antiColor(c2), c1);
-                vault.recolor(c2, ColorPair::antiColor(c1));
+                vault.addCell(link.second( ), vault.antiColor(c1));
+            else if ( c1 != vault.antiColor(c2) ) {
+                vault.recolor(vault.antiColor(c2), c1);
+                vault.recolor(c2, vault.antiColor(c1));
             } else {
                 // loop
             }
         }
     }
     for ( BiLocationLink& link: links ) {
-        LOG_STREAM << (int)candidate << "bi-location link: " << link.first( )->coord( ) << vault.getColor(link.first( )) << link.second( )->coord( ) << vault.getColor(link.second( )) << std::endl;
+        SUDOKU_LOG(Info) << (int)candidate << "bi-location link: " << link.first( )->coord( ) << vault.getColor(link.first( )) << link.second( )->coord( ) << vault.getColor(link.second( )) << '\n';
     }
     for ( House* house: areas( ) ) {
         // check for houses with 2 cells of same color
-        CellSet              cellsWithCandidate = house->cellsWithCandidate(candidate);
+        CellBitSet           cellsWithCandidate = field.candidatePositions(*house, candidate);
         QMap<CellColor, int> presentColor;
-        for ( Cell* cell: cellsWithCandidate ) {
-            CellColor color = vault.getColor(cell);
+        for ( quint16 idx: cellsWithCandidate ) {
+            CellColor color = vault.getColor(cells( )[idx]);
             if ( color != ColorPair::UnknownColor ) {
                 presentColor[color]++;
                 if ( presentColor[color] > 1 ) {
                     // we've found house with 2 cells from same chain and same color
                     // this mean -- all cells with this color in this chain are OFF
-                    LOG_STREAM << "two cells with same color in one house: this color is OFF" << std::endl;
-                    changed |= vault.removeCandidateForColor(color);
+                    SUDOKU_LOG(Info) << "two cells with same color in one house: this color is OFF" << '\n';
+                    for ( Cell* pCell: vault.cells(color) )
+                        changed |= eliminate(pCell, CandidateMask::single(candidate));
+                    for ( Cell* pCell: vault.cells(vault.antiColor(color)) )
+                        changed |= place(pCell, candidate);
                 }
             }
         }
     }
-    for ( Cell* c: cells( ) ) {
+    const CellBitSet candidateCells = field.candidatePlanes( ).digit(candidate);
+    for ( quint16 idx: candidateCells ) {
+        Cell* c = cells( )[idx];
         if ( !c->hasCandidate(candidate) )
             continue;
 
@@ -373,15 +493,15 @@ bool BiLocationColoringTechnique::runPerCandidate(CellValue candidate)
             continue;
 
         QVector<CellColor> visibleColors;
-        CellSet            visibleCells = field.allCellsVisibleFromCell(c);
-        for ( Cell* pCell: visibleCells ) {
+        for ( quint16 peerIdx: field.geometry( ).peers(idx) ) {
+            Cell*     pCell = cells( )[peerIdx];
             CellColor color = vault.getColor(pCell);
             if ( color == ColorPair::UnknownColor )
                 continue;
-            CellColor acolor = ColorPair::antiColor(color);
+            CellColor acolor = vault.antiColor(color);
             if ( visibleColors.contains(acolor) ) {
-                LOG_STREAM << "Non-colored cell " << c->coord( ) << " can see color " << color << " and its antiColor " << acolor << ": this cell is OFF" << std::endl;
-                changed |= c->removeCandidate(candidate);
+                SUDOKU_LOG(Info) << "Non-colored cell " << c->coord( ) << " can see color " << color << " and its antiColor " << acolor << ": this cell is OFF" << '\n';
+                changed |= eliminate(c, CandidateMask::single(candidate));
                 break;
             }
             visibleColors.append(color);
@@ -395,9 +515,12 @@ QVector<BiLocationLink> BiLocationColoringTechnique::findBiLocationLinks(CellVal
 {
     QVector<BiLocationLink> ret;
     for ( House* house: areas( ) ) {
-        CellSet lst = house->cellsWithCandidate(val);
-        if ( lst.count( ) == 2 ) {
-            BiLocationLink link(val, lst[0], lst[1]);
+        CellBitSet positions = field.candidatePositions(*house, val);
+        if ( positions.count( ) == 2 ) {
+            auto           it = positions.begin( );
+            Cell::Ptr      c1 = cells( )[*it];
+            Cell::Ptr      c2 = cells( )[*++it];
+            BiLocationLink link(val, c1, c2);
             if ( !ret.contains(link) )
                 ret.append(link);
         }
@@ -405,7 +528,7 @@ QVector<BiLocationLink> BiLocationColoringTechnique::findBiLocationLinks(CellVal
     return ret;
 }
 
-XWingTechnique::XWingTechnique(Field& field, bool enabled, QObject* parent) : Technique(field, "X-Wing", enabled, parent)
+XWingTechnique::XWingTechnique(Field& field, bool enabled) : Technique(field, "X-Wing", enabled)
 {
 }
 
@@ -413,67 +536,46 @@ bool XWingTechnique::run( )
 {
     bool changed = false;
 
-    for ( quint8 colA_idx = 1; colA_idx <= columns( ).count( ) - 1; colA_idx++ ) {
-        ColumnHouse& columnA = columns( )[colA_idx - 1];
-        for ( quint8 colB_idx = colA_idx + 1; colB_idx <= columns( ).count( ); colB_idx++ ) {
-            ColumnHouse& columnB = columns( )[colB_idx - 1];
-            for ( quint8 row1_idx = 1; row1_idx <= rows( ).count( ) - 1; row1_idx++ ) {
-                RowHouse& row1 = rows( )[row1_idx - 1];
-                for ( quint8 row2_idx = row1_idx + 1; row2_idx <= rows( ).count( ); row2_idx++ ) {
-                    RowHouse& row2 = rows( )[row2_idx - 1];
-
-                    QBitArray mask(N);
-                    Coord     A1(row1_idx, colA_idx);
-                    Coord     A2(row2_idx, colA_idx);
-                    Coord     B1(row1_idx, colB_idx);
-                    Coord     B2(row2_idx, colB_idx);
-
-                    Cell::Ptr cA1 = cell(A1);
-                    Cell::Ptr cA2 = cell(A2);
-                    Cell::Ptr cB1 = cell(B1);
-                    Cell::Ptr cB2 = cell(B2);
-
-                    if ( cA1->isResolved( ) || cA2->isResolved( ) || cB1->isResolved( ) || cB2->isResolved( ) )
-                        continue;
-
-                    mask = cA1->commonCandidates(cA2);
-                    mask &= cB1->commonCandidates(cB2);
-
-                    for ( quint8 bit = 0; bit < mask.count( ); bit++ ) {
-                        CellValue value = bit + 1;
-                        if ( !mask.testBit(bit) )
-                            continue;
-                        if ( columnA.candidatesCount(value) == 2 && columnB.candidatesCount(value) == 2 && (row1.candidatesCount(value) > 2 || row2.candidatesCount(value) > 2) ) {
-                            LOG_STREAM << "columns x-wing found for " << (int)value << " in " << A1 << A2 << B1 << B2 << std::endl;
-                            for ( quint8 col = 1; col <= columns( ).count( ); col++ ) {
-                                if ( col == colA_idx || col == colB_idx )
-                                    continue;
-                                Coord c1(row1_idx, col);
-                                changed |= cell(c1)->removeCandidate(value);
-                                Coord c2(row2_idx, col);
-                                changed |= cell(c2)->removeCandidate(value);
-                            }
-                        }
-                        if ( row1.candidatesCount(value) == 2 && row2.candidatesCount(value) == 2 && (columnA.candidatesCount(value) > 2 || columnB.candidatesCount(value) > 2) ) {
-                            LOG_STREAM << "rows x-wing found for " << (int)value << " in " << A1 << A2 << B1 << B2 << std::endl;
-                            for ( quint8 row = 1; row <= rows( ).count( ); row++ ) {
-                                if ( row == row1_idx || row == row2_idx )
-                                    continue;
-                                Coord c1(row, colA_idx);
-                                changed |= cell(c1)->removeCandidate(value);
-                                Coord c2(row, colB_idx);
-                                changed |= cell(c2)->removeCandidate(value);
-                            }
-                        }
-                    }
-                }
+    // base houses hold the digit in exactly two cells which line up in the same two cover houses;
+    // the digit is then removed from the rest of both cover houses.
+    // A position inside a line is the index of the crossing line, so "line up" is plain mask equality.
+    auto reduceFish = [this] (CellValue value, auto& baseHouses, auto& coverHouses, const char* kind) {
+        using Positions = CandidatePlanes::HousePositions;
+        bool ret = false;
+        for ( int a = 0; a < baseHouses.count( ) - 1 && !isCancelled( ); a++ ) {
+            const Positions posA = baseHouses[a].candidatePositions(value);
+            if ( std::popcount(posA) != 2 )
+                continue;
+            for ( int b = a + 1; b < baseHouses.count( ); b++ ) {
+                if ( baseHouses[b].candidatePositions(value) != posA )
+                    continue;
+
+                const Positions bases  = (Positions {1} << a) | (Positions {1} << b);
+                const int       cover1 = std::countr_zero(posA);
+                const int       cover2 = std::countr_zero(posA & (posA - 1));
+                Positions       extra1 = coverHouses[cover1].candidatePositions(value) & ~bases;
+                Positions       extra2 = coverHouses[cover2].candidatePositions(value) & ~bases;
+                if ( !extra1 && !extra2 )
+                    continue;
+                SUDOKU_LOG(Info) << kind << " x-wing found for " << (int)value << " in " << baseHouses[a][cover1]->coord( ) << baseHouses[a][cover2]->coord( ) << baseHouses[b][cover1]->coord( )
+                           << baseHouses[b][cover2]->coord( ) << '\n';
+                for ( ; extra1; extra1 &= extra1 - 1 )
+                    ret |= eliminate(coverHouses[cover1][std::countr_zero(extra1)], CandidateMask::single(value));
+                for ( ; extra2; extra2 &= extra2 - 1 )
+                    ret |= eliminate(coverHouses[cover2][std::countr_zero(extra2)], CandidateMask::single(value));
             }
         }
+        return ret;
+    };
+
+    for ( CellValue value = 1; value <= N && !isCancelled( ); value++ ) {
+        changed |= reduceFish(value, columns( ), rows( ), "columns");
+        changed |= reduceFish(value, rows( ), columns( ), "rows");
     }
     return changed;
 }
 
-YWingTechnique::YWingTechnique(Field& field, bool enabled, QObject* parent) : PerCellTechnique(field, "Y-Wing", enabled, parent)
+YWingTechnique::YWingTechnique(Field& field, bool enabled) : PerCellTechnique(field, "Y-Wing", enabled)
 {
 }
 
@@ -484,43 +586,45 @@ bool YWingTechnique::runPerCell(Cell::Ptr cellAB)
     if ( cellAB->candidatesCount( ) != 2 )
         return ret;
 
-    QVector<CellValue> candidates = cellAB->candidates( );
-    CellValue          A          = candidates[0];
-    CellValue          B          = candidates[1];
+    CandidateMask candidates = cellAB->candidatesMask( );
+    CellValue     A          = candidates.first( );
+    CellValue     B          = (candidates & ~CandidateMask::single(A)).first( );
 
-    CellSet visibleFromAB = field.allCellsVisibleFromCell(cellAB);
     CellSet biValueCellsVisibleFromAB;
-    for ( Cell* c: visibleFromAB )
+    for ( quint16 idx: field.geometry( ).peers(cellAB->coord( ).rawIndex( )) ) {
+        Cell* c = cells( )[idx];
         if ( c->candidatesCount( ) == 2 )
             biValueCellsVisibleFromAB.addCell(c);
+    }
 
     for ( CellValue C = 1; C <= N; C++ ) {
         // this can be paralleled for every C
         if ( A == C || B == C )
             continue;
 
-        CellSet cellsAC;
-        CellSet cellsBC;
+        CellSet             cellsAC;
+        CellSet             cellsBC;
+        const CandidateMask maskAC = CandidateMask::single(A) | CandidateMask::single(C);
+        const CandidateMask maskBC = CandidateMask::single(B) | CandidateMask::single(C);
 
         for ( Cell* c: biValueCellsVisibleFromAB ) {
-            if ( c->hasCandidate(C) && c->hasCandidate(A) )
+            if ( c->candidatesExactMatch(maskAC) )
                 cellsAC.addCell(c);
-            if ( c->hasCandidate(C) && c->hasCandidate(B) )
+            if ( c->candidatesExactMatch(maskBC) )
                 cellsBC.addCell(c);
         }
 
         for ( Cell* ac: cellsAC )
             for ( Cell* bc: cellsBC ) {
-                LOG_STREAM << "Y-Wing found: " << cellAB->coord( ) << " " << ac->coord( ) << " " << bc->coord( ) << std::endl;
-                CellSet visibleFromBoth = field.allCellsVisibleFromBothCell(ac, bc);
-                ret |= visibleFromBoth.removeCandidate(C);
+                SUDOKU_LOG(Info) << "Y-Wing found: " << cellAB->coord( ) << " " << ac->coord( ) << " " << bc->coord( ) << '\n';
+                ret |= eliminate(field.visibleFromBoth(ac, bc), C);
             }
     }
 
     return ret;
 }
 
-XYZWingTechnique::XYZWingTechnique(Field& field, bool enabled, QObject* parent) : PerCellTechnique(field, "XYZ-Wing", enabled, parent)
+XYZWingTechnique::XYZWingTechnique(Field& field, bool enabled) : PerCellTechnique(field, "XYZ-Wing", enabled)
 {
 }
 
@@ -531,15 +635,52 @@ bool XYZWingTechnique::runPerCell(Cell::Ptr xyzcell)
     if ( xyzcell->candidatesCount( ) != 3 )
         return ret;
 
-    QVector<CellValue> xyzvalues = xyzcell->candidates( );
+    CandidateMask xyzvalues = xyzcell->candidatesMask( );
+    auto          xyzIt     = xyzvalues.begin( );
+
+    CellValue v1 = *xyzIt;
+    CellValue v2 = *++xyzIt;
+    CellValue v3 = *++xyzIt;
+
+    const Geometry& geometry = field.geometry( );
+    const quint16   xyzIdx   = xyzcell->coord( ).rawIndex( );
+    const quint8    xyzRow   = geometry.row(xyzIdx);
+    const quint8    xyzCol   = geometry.column(xyzIdx);
+    const quint8    xyzSq    = geometry.square(xyzIdx);
+
+    // yz wing lies on the apex row or column (\a line, \a lineMask), but not on the line of the xz wing
+    auto findWing = [&] (Cell::Ptr xzcell, CellValue y, std::span<const quint16> line, const CellBitSet& lineMask, const CellBitSet& lineOfXZ) {
+        for ( quint16 yzIdx: line ) {
+            if ( yzIdx == xyzIdx )
+                continue;
+            Cell::Ptr yzcell = cells( )[yzIdx];
+            if ( yzcell->candidatesCount( ) != 2 || xyzcell->commonCandidatesCount(yzcell) != 2 || !yzcell->hasCandidate(y) )
+                continue;
+            CellValue z;
+            if ( yzcell->hasCandidate(v1) && y != v1 )
+                z = v1;
+            else if ( yzcell->hasCandidate(v2) && y != v2 )
+                z = v2;
+            else
+                z = v3;
+
+            if ( lineOfXZ.test(yzIdx) )
+                continue;
 
-    CellValue v1 = xyzvalues[0];
-    CellValue v2 = xyzvalues[1];
-    CellValue v3 = xyzvalues[2];
+            SUDOKU_LOG(Info) << "XYZ-Wing found with apex " << xyzcell->coord( ) << " and wings " << xzcell->coord( ) << " / " << yzcell->coord( ) << " Z is " << (int)z << '\n';
 
-    QVector<Coord> squareCoords = xyzcell->coord( ).sameSquareCoordinates( );
-    for ( const Coord& xz_co: squareCoords ) {
-        Cell::Ptr sq_cell = cell(xz_co);
+            // cells of the apex square lying on the yz line see all three cells
+            CellBitSet target = geometry.squareMask(xyzSq) & lineMask;
+            target.reset(xyzIdx);
+            target.reset(yzIdx);
+            ret |= eliminate(target, z);
+        }
+    };
+
+    for ( quint16 xzIdx: geometry.squareCells(xyzSq) ) {
+        if ( xzIdx == xyzIdx )
+            continue;
+        Cell::Ptr sq_cell = cells( )[xzIdx];
         if ( sq_cell->candidatesCount( ) == 2 && xyzcell->commonCandidatesCount(sq_cell) == 2 ) {
             Cell::Ptr xzcell = sq_cell;
             CellValue y;
@@ -550,55 +691,8 @@ bool XYZWingTechnique::runPerCell(Cell::Ptr xyzcell)
             else
                 y = v3;
 
-            QVector<Coord> rowCoords = xyzcell->coord( ).sameRowCoordinates( );
-            for ( const Coord& yz_co: rowCoords ) {
-                Cell::Ptr row_cell = cell(yz_co);
-                if ( row_cell->candidatesCount( ) == 2 && xyzcell->commonCandidatesCount(row_cell) == 2 && row_cell->hasCandidate(y) ) {
-                    Cell::Ptr yzcell = row_cell;
-                    CellValue z;
-                    if ( yzcell->hasCandidate(v1) && y != v1 )
-                        z = v1;
-                    else if ( yzcell->hasCandidate(v2) && y != v2 )
-                        z = v2;
-                    else
-                        z = v3;
-
-                    if ( xz_co.row( ) == yz_co.row( ) )
-                        continue;
-
-                    LOG_STREAM << "XYZ-Wing found with apex " << xyzcell->coord( ) << " and wings " << xzcell->coord( ) << " / " << yzcell->coord( ) << " Z is " << (int)z << std::endl;
-
-                    for ( const Coord& co: yz_co.sameRowCoordinates( ) ) {
-                        if ( co.squareIdx( ) == xyzcell->coord( ).squareIdx( ) && co != xyzcell->coord( ) )
-                            ret |= cell(co)->removeCandidate(z);
-                    }
-                }
-            }
-
-            QVector<Coord> colCoords = xyzcell->coord( ).sameColumnCoordinates( );
-            for ( const Coord& yz_co: colCoords ) {
-                Cell::Ptr col_cell = cell(yz_co);
-                if ( col_cell->candidatesCount( ) == 2 && xyzcell->commonCandidatesCount(col_cell) == 2 && col_cell->hasCandidate(y) ) {
-                    Cell::Ptr yzcell = col_cell;
-                    CellValue z;
-                    if ( yzcell->hasCandidate(v1) && y != v1 )
-                        z = v1;
-                    else if ( yzcell->hasCandidate(v2) && y != v2 )
-                        z = v2;
-                    else
-                        z = v3;
-
-                    if ( xz_co.col( ) == yz_co.col( ) )
-                        continue;
-
-                    LOG_STREAM << "XYZ-Wing found with apex " << xyzcell->coord( ) << " and wings " << xzcell->coord( ) << " / " << yzcell->coord( ) << " Z is " << (int)z << std::endl;
-
-                    for ( const Coord& co: yz_co.sameColumnCoordinates( ) ) {
-                        if ( co.squareIdx( ) == xyzcell->coord( ).squareIdx( ) && co != xyzcell->coord( ) )
-                            ret |= cell(co)->removeCandidate(z);
-                    }
-                }
-            }
+            findWing(xzcell, y, geometry.rowCells(xyzRow), geometry.rowMask(xyzRow), geometry.rowMask(geometry.row(xzIdx)));
+            findWing(xzcell, y, geometry.columnCells(xyzCol), geometry.columnMask(xyzCol), geometry.columnMask(geometry.column(xzIdx)));
         }
     }
 
@@ -607,25 +701,39 @@ bool XYZWingTechnique::runPerCell(Cell::Ptr xyzcell)
 
 bool PerCellTechnique::run( )
 {
+    const bool             skipClean = incremental && scope( ) == Scope::Region;
+    const CandidatePlanes& planes    = field.candidatePlanes( );
+    QVector<Cell::Ptr>&    all       = cells( );
+    if ( cleanBefore.count( ) != all.count( ) )
+        cleanBefore.fill(0, all.count( ));
+
+    auto scan = [&] (int idx) {
+        if ( skipClean && planes.lastCellChange(idx) < cleanBefore[idx] ) {
+            countScan(true);
+            return false;
+        }
+        if ( isCancelled( ) )
+            return false;
+        countScan(false);
+        const quint64 changesBefore = planes.lastChange( );
+        Cell::Ptr     pCell         = all[idx];
+        // observers expect the calling thread
+        const bool notify = observer && !pool;
+        if ( notify )
+            observer->cellAnalyzeStarted(this, pCell);
+        const bool changed = runPerCell(pCell);
+        if ( notify )
+            observer->cellAnalyzeFinished(this, pCell);
+        if ( !changed && !isCancelled( ) )
+            cleanBefore[idx] = changesBefore + 1;
+        return changed;
+    };
+    if ( pool )
+        return runParallel(all.count( ), scan);
+
     bool ret = false;
-#ifdef MT
-    QtConcurrent::blockingFilteredReduced<bool>(
-        cells( ),
-        [this] (Cell::Ptr cell) {
-        return runPerCell(cell);
-    },
-        [] (bool& result, const bool& intermediate) {
-        result |= intermediate;
-    });
-#else
-    for ( Cell::Ptr pCell: cells( ) ) {
-        emit cellAnalyzeStarted(pCell);
-        ret |= runPerCell(pCell);
-        emit cellAnalyzeFinished(pCell);
-        if ( ret )
-            break;
-    }
-#endif
+    for ( int idx = 0; idx < all.count( ) && !(ret && !collectsAll( )) && !isCancelled( ); idx++ )
+        ret |= scan(idx);
     return ret;
 }
 
@@ -638,10 +746,10 @@ std::ostream& operator<< (std::ostream& stream, UniqueRectangle::Rectangle& r)
 bool UniqueRectangle::Rectangle::applyType1Check( )
 {
     if ( sameRowCell->candidatesExactMatch(cell) && sameColumnCell->candidatesExactMatch(cell) ) {
-        QBitArray commonCandidates = diagonalCell->commonCandidates(cell);
-        if ( commonCandidates.count(true) == 2 ) {
-            LOG_STREAM << "Unique Rectangle Type 1" << *this << std::endl;
-            return diagonalCell->removeCandidate(commonCandidates);
+        CandidateMask commonCandidates = diagonalCell->commonCandidates(cell);
+        if ( commonCandidates.count( ) == 2 ) {
+            SUDOKU_LOG(Info) << "Unique Rectangle Type 1" << *this << '\n';
+            return technique.eliminate(diagonalCell, commonCandidates);
         }
     }
     return false;
@@ -649,45 +757,33 @@ bool UniqueRectangle::Rectangle::applyType1Check( )
 
 bool UniqueRectangle::Rectangle::applyType2aCheck( )
 {
-    if ( cell->candidatesExactMatch(neigborCell) && cell->commonCandidates(diagonalCell).count(true) == 2 && diagNeigborCell->candidatesExactMatch(diagonalCell)
+    if ( cell->candidatesExactMatch(neigborCell) && cell->commonCandidates(diagonalCell).count( ) == 2 && diagNeigborCell->candidatesExactMatch(diagonalCell)
          && diagonalCell->candidatesCount( ) == 3 ) {
-        LOG_STREAM << "Unique Rectangle Type 2A" << *this << std::endl;
-        QVector<CellValue> cellValues = cell->candidates( );
-        QVector<CellValue> diagValues = diagonalCell->candidates( );
-        for ( CellValue v: cellValues )
-            diagValues.removeAll(v);
-        CellValue candidateToRemove = diagValues[0];
-        return field.allCellsVisibleFromBothCell(diagonalCell, diagNeigborCell).removeCandidate(candidateToRemove);
+        SUDOKU_LOG(Info) << "Unique Rectangle Type 2A" << *this << '\n';
+        CellValue candidateToRemove = (diagonalCell->candidatesMask( ) & ~cell->candidatesMask( )).first( );
+        return technique.eliminate(field.visibleFromBoth(diagonalCell, diagNeigborCell), candidateToRemove);
     }
     return false;
 }
 
 bool UniqueRectangle::Rectangle::applyType2bCheck( )
 {
-    if ( cell->candidatesExactMatch(diagNeigborCell) && cell->commonCandidates(neigborCell).count(true) == 2 && neigborCell->candidatesExactMatch(diagonalCell)
+    if ( cell->candidatesExactMatch(diagNeigborCell) && cell->commonCandidates(neigborCell).count( ) == 2 && neigborCell->candidatesExactMatch(diagonalCell)
          && neigborCell->candidatesCount( ) == 3 ) {
-        LOG_STREAM << "Unique Rectangle Type 2B" << *this << std::endl;
-        QVector<CellValue> cellValues = cell->candidates( );
-        QVector<CellValue> neigValues = neigborCell->candidates( );
-        for ( CellValue v: cellValues )
-            neigValues.removeAll(v);
-        CellValue candidateToRemove = neigValues[0];
-        return field.allCellsVisibleFromBothCell(neigborCell, diagonalCell).removeCandidate(candidateToRemove);
+        SUDOKU_LOG(Info) << "Unique Rectangle Type 2B" << *this << '\n';
+        CellValue candidateToRemove = (neigborCell->candidatesMask( ) & ~cell->candidatesMask( )).first( );
+        return technique.eliminate(field.visibleFromBoth(neigborCell, diagonalCell), candidateToRemove);
     }
     return false;
 }
 
 bool UniqueRectangle::Rectangle::applyType2cCheck( )
 {
-    if ( cell->candidatesExactMatch(diagonalCell) && cell->commonCandidates(neigborCell).count(true) == 2 && neigborCell->candidatesExactMatch(diagNeigborCell)
+    if ( cell->candidatesExactMatch(diagonalCell) && cell->commonCandidates(neigborCell).count( ) == 2 && neigborCell->candidatesExactMatch(diagNeigborCell)
          && neigborCell->candidatesCount( ) == 3 ) {
-        LOG_STREAM << "Unique Rectangle Type 2C" << *this << std::endl;
-        QVector<CellValue> cellValues = cell->candidates( );
-        QVector<CellValue> neigValues = neigborCell->candidates( );
-        for ( CellValue v: cellValues )
-            neigValues.removeAll(v);
-        CellValue candidateToRemove = neigValues[0];
-        return field.allCellsVisibleFromBothCell(neigborCell, diagNeigborCell).removeCandidate(candidateToRemove);
+        SUDOKU_LOG(Info) << "Unique Rectangle Type 2C" << *this << '\n';
+        CellValue candidateToRemove = (neigborCell->candidatesMask( ) & ~cell->candidatesMask( )).first( );
+        return technique.eliminate(field.visibleFromBoth(neigborCell, diagNeigborCell), candidateToRemove);
     }
     return false;
 }
@@ -695,32 +791,28 @@ bool UniqueRectangle::Rectangle::applyType2cCheck( )
 bool UniqueRectangle::Rectangle::applyType3aCheck( )
 {
     bool ret = false;
-    if ( cell->candidatesExactMatch(diagNeigborCell) && cell->commonCandidates(neigborCell).count(true) == 2 && cell->commonCandidates(diagonalCell).count(true) == 2
+    if ( cell->candidatesExactMatch(diagNeigborCell) && cell->commonCandidates(neigborCell).count( ) == 2 && cell->commonCandidates(diagonalCell).count( ) == 2
          && neigborCell->candidatesCount( ) == 3 && diagonalCell->candidatesCount( ) == 3 && !diagonalCell->candidatesExactMatch(neigborCell) ) {
-        LOG_STREAM << "Unique rectangle type 3A" << *this << std::endl;
-        QVector<CellValue> vals1      = diagonalCell->candidates( );
-        QVector<CellValue> vals2      = neigborCell->candidates( );
-        QVector<CellValue> baseValues = cell->candidates( );
-        for ( CellValue v: baseValues ) {
-            vals1.removeAll(v);
-            vals2.removeAll(v);
-        }
-        LOG_STREAM << "virtual cell values from roof are " << (int)vals1[0] << " " << (int)vals2[0] << std::endl;
-        QBitArray virtualCellCandidates(cell->candidatesCapacity( ));
-        virtualCellCandidates.setBit(vals1[0] - 1);
-        virtualCellCandidates.setBit(vals2[0] - 1);
-        Cell* pair = nullptr;
-        for ( auto c: field.allCellsVisibleFromBothCell(diagonalCell, neigborCell) ) {
+        SUDOKU_LOG(Info) << "Unique rectangle type 3A" << *this << '\n';
+        CellValue val1 = (diagonalCell->candidatesMask( ) & ~cell->candidatesMask( )).first( );
+        CellValue val2 = (neigborCell->candidatesMask( ) & ~cell->candidatesMask( )).first( );
+        SUDOKU_LOG(Info) << "virtual cell values from roof are " << (int)val1 << " " << (int)val2 << '\n';
+        CandidateMask virtualCellCandidates = CandidateMask::single(val1) | CandidateMask::single(val2);
+        Cell*            pair        = nullptr;
+        const CellBitSet roofVisible = field.visibleFromBoth(diagonalCell, neigborCell);
+        for ( quint16 idx: roofVisible ) {
+            Cell* c = field.cellAt(idx);
             if ( c->candidatesExactMatch(virtualCellCandidates) ) {
-                LOG_STREAM << "pair found" << c->coord( ) << std::endl;
+                SUDOKU_LOG(Info) << "pair found" << c->coord( ) << '\n';
                 pair = c;
                 break;
             }
         }
         if ( pair ) {
-            for ( auto c: field.allCellsVisibleFromBothCell(diagonalCell, neigborCell) ) {
+            for ( quint16 idx: roofVisible ) {
+                Cell* c = field.cellAt(idx);
                 if ( c != pair ) {
-                    ret |= c->removeCandidate(virtualCellCandidates);
+                    ret |= technique.eliminate(c, virtualCellCandidates);
                 }
             }
         }
@@ -731,27 +823,20 @@ bool UniqueRectangle::Rectangle::applyType3aCheck( )
 bool UniqueRectangle::Rectangle::applyType3bCheck( )
 {
     bool ret = false;
-    if ( cell->candidatesExactMatch(neigborCell) && cell->commonCandidates(diagonalCell).count(true) == 2 && cell->commonCandidates(diagNeigborCell).count(true) == 2
+    if ( cell->candidatesExactMatch(neigborCell) && cell->commonCandidates(diagonalCell).count( ) == 2 && cell->commonCandidates(diagNeigborCell).count( ) == 2
          && diagNeigborCell->candidatesCount( ) == 3 && diagonalCell->candidatesCount( ) == 3 && !diagonalCell->candidatesExactMatch(diagNeigborCell) ) {
-        LOG_STREAM << "Unique rectangle type 3B" << *this << std::endl;
-        QVector<CellValue> vals1      = diagonalCell->candidates( );
-        QVector<CellValue> vals2      = diagNeigborCell->candidates( );
-        QVector<CellValue> baseValues = cell->candidates( );
-        for ( CellValue v: baseValues ) {
-            vals1.removeAll(v);
-            vals2.removeAll(v);
-        }
-        LOG_STREAM << "virtual cell values from roof are " << (int)vals1[0] << " " << (int)vals2[0] << std::endl;
-        QBitArray virtualCellCandidates(cell->candidatesCapacity( ));
-        virtualCellCandidates.setBit(vals1[0] - 1);
-        virtualCellCandidates.setBit(vals2[0] - 1);
+        SUDOKU_LOG(Info) << "Unique rectangle type 3B" << *this << '\n';
+        CellValue val1 = (diagonalCell->candidatesMask( ) & ~cell->candidatesMask( )).first( );
+        CellValue val2 = (diagNeigborCell->candidatesMask( ) & ~cell->candidatesMask( )).first( );
+        SUDOKU_LOG(Info) << "virtual cell values from roof are " << (int)val1 << " " << (int)val2 << '\n';
+        CandidateMask virtualCellCandidates = CandidateMask::single(val1) | CandidateMask::single(val2);
         for ( House::CPtr hs: field.commonHouses(diagonalCell, diagNeigborCell) ) {
             Cell* pair = nullptr;
             for ( auto c: *hs ) {
                 if ( c == diagonalCell || c == diagNeigborCell )
                     continue;
                 if ( c->candidatesExactMatch(virtualCellCandidates) ) {
-                    LOG_STREAM << "pair found" << c->coord( ) << std::endl;
+                    SUDOKU_LOG(Info) << "pair found" << c->coord( ) << '\n';
                     pair = c;
                     break;
                 }
@@ -759,7 +844,7 @@ bool UniqueRectangle::Rectangle::applyType3bCheck( )
             if ( pair ) {
                 for ( auto c: *hs ) {
                     if ( c != pair && c != diagonalCell && c != diagNeigborCell ) {
-                        ret |= c->removeCandidate(virtualCellCandidates);
+                        ret |= technique.eliminate(c, virtualCellCandidates);
                     }
                 }
             }
@@ -768,7 +853,7 @@ bool UniqueRectangle::Rectangle::applyType3bCheck( )
     return ret;
 }
 
-UniqueRectangle::UniqueRectangle(Field& field, bool enabled, QObject* parent) : PerCellTechnique(field, "Unique Rectangle", enabled, parent)
+UniqueRectangle::UniqueRectangle(Field& field, bool enabled) : PerCellTechnique(field, "Unique Rectangle", enabled)
 {
 }
 
@@ -779,10 +864,12 @@ bool UniqueRectangle::runPerCell(Cell::Ptr pCell)
         return false;
     RowHouse&    row = rows( )[pCell->coord( ).row( ) - 1];
     ColumnHouse& col = columns( )[pCell->coord( ).col( ) - 1];
-    Rectangle    rect(field);
+    Rectangle    rect(*this);
     rect.cell = pCell;
 
     for ( Cell::Ptr cellInSameRow: row ) {
+        if ( isCancelled( ) )
+            break;
         if ( cellInSameRow == pCell )
             continue;
         if ( cellInSameRow->isResolved( ) )
@@ -796,7 +883,7 @@ bool UniqueRectangle::runPerCell(Cell::Ptr pCell)
                 continue;
             rect.sameColumnCell = cellInSameColumn;
 
-            rect.diagonalCell = cell(Coord(cellInSameColumn->coord( ).row( ), cellInSameRow->coord( ).col( )));
+            rect.diagonalCell = cell(Coord(cellInSameColumn->coord( ).row( ), cellInSameRow->coord( ).col( ), N));
             if ( rect.diagonalCell->isResolved( ) )
                 continue;
             if ( rect.diagonalCell->coord( ).squareIdx( ) == pCell->coord( ).squareIdx( ) )
@@ -824,26 +911,12 @@ bool UniqueRectangle::runPerCell(Cell::Ptr pCell)
 
 bool PerCandidateTechnique::run( )
 {
-    bool                    ret = false;
-    static QList<CellValue> candidates;
-    if ( field.getN( ) != candidates.count( ) )
-        for ( CellValue i = 1; i <= field.getN( ); i++ )
-            candidates.append(i);
-#ifdef MT
-    QtConcurrent::blockingFilteredReduced<bool>(
-        candidates,
-        [this] (CellValue candidate) {
-        return runPerCandidate(candidate);
-    },
-        [] (bool& result, const bool& intermediate) {
-        result |= intermediate;
-    });
-#else
-    for ( CellValue candidate: candidates ) {
-        ret |= runPerCandidate(candidate);
-        if ( ret )
-            break;
-    }
-#endif
+    auto scan = [this] (int i) { return !isCancelled( ) && runPerCandidate(static_cast<CellValue>(i + 1)); };
+    if ( pool )
+        return runParallel(N, scan);
+
+    bool ret = false;
+    for ( int i = 0; i < N && !(ret && !collectsAll( )) && !isCancelled( ); i++ )
+        ret |= scan(i);
     return ret;
 }
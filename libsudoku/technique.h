@@ -3,30 +3,69 @@
 
 #include "house.h"
 #include "bilocationlink.h"
+#include "canceltoken.h"
+#include "observer.h"
+#include "geometry.h"
 
 #include <QString>
-#include <QBitArray>
+#include <QVector>
 
-#include <chrono>
-#include <thread>
+#include <functional>
+#include <sstream>
+#include <vector>
+
+class QThreadPool;
 
 class Field;
 
-class Technique : public QObject
+class Technique
 {
-    Q_OBJECT
     const QString techniqueName;
     bool enabled;
-    static void fillCandidatesCombinationsMasks(quint8 n);
 public:
-    Technique (Field& field, const QString& name, bool enabled = true, QObject* parent = nullptr);
+    Technique (Field& field, const QString& name, bool enabled = true);
+    virtual ~Technique() = default;
+    /*! \brief \a observer is notified about run progress, nullptr detaches; not owned */
+    void setObserver(TechniqueObserver* observer) { this->observer = observer; }
     const QString& name() const {return techniqueName;}
     virtual void setEnabled(bool enabled = true);
     virtual bool canBeDisabled() const { return true;}
     bool isEnabled() const {return enabled;}
+    /*! \brief lets per-cell and per-house techniques skip regions unchanged since they last gave nothing there; on by default */
+    void setIncremental(bool incremental) { this->incremental = incremental; }
+    bool isIncremental() const { return incremental; }
+    /*! \brief makes one run() gather the eliminations of every cell or house on the
+     * current state and apply them together instead of stopping at the first hit; off by default
+     */
+    void setBatch(bool batch) { this->batch = batch; }
+    bool isBatch() const { return batch; }
+    /*! \brief lets per-cell, per-house and per-candidate techniques spread their regions over \a pool; nullptr (default) keeps them on the calling thread; not owned
+     *
+     * Workers only read the field and queue what they find, the calling thread merges it in
+     * region order and applies it, so parallel runs give the results of batch mode.
+     * Per-cell observer notifications are not sent from workers.
+     */
+    void setThreadPool(QThreadPool* pool) { this->pool = pool; }
+    QThreadPool* threadPool() const { return pool; }
+    /*! \brief long loops give up once \a token is cancelled, nullptr (default) never; not owned */
+    void setCancelToken(const CancelToken* token) { cancelToken = token; }
+    /// cells or houses examined so far
+    quint64 regionScans() const { return scans; }
+    /// cells or houses skipped as unchanged so far
+    quint64 regionsSkipped() const { return skips; }
+    /// perform() calls that did run
+    quint64 runsCount() const { return runs; }
+    /// nanoseconds spent in run() so far
+    quint64 timeSpent() const { return spentNs; }
+    /// cell changes made so far, counted by CandidatePlanes::lastChange()
+    quint64 changesMade() const { return changes; }
+    /// cheap techniques keep running first under any schedule
+    virtual bool isCheap() const { return false; }
     bool perform();
 protected:
-    static QSet<QBitArray> allCandidatesCombinationsMasks;
+    /// what one per-cell or per-house check reads: only its own region, or anything on the board
+    enum class Scope { Region, Board };
+
     QVector<House::Ptr>& areas();
     QVector<SquareHouse>& squares();
     QVector<RowHouse>& rows();
@@ -34,47 +73,96 @@ protected:
     QVector<Cell::Ptr>& cells();
     Cell::Ptr cell(const Coord& c);
 
+    /*! \brief removes \a mask from \a pCell; in batch mode only queues it
+     * \return true if anything is removed, or queued and not queued before
+     */
+    bool eliminate(Cell::Ptr pCell, CandidateMask mask);
+    /*! \brief removes \a value from cells \a where, see eliminate(Cell::Ptr, CandidateMask) */
+    bool eliminate(const CellBitSet& where, CellValue value);
+    /*! \brief sets \a value into \a pCell; in batch mode only queues it */
+    bool place(Cell::Ptr pCell, CellValue value);
+    /// polled by long loops; what was found before stays valid
+    bool isCancelled() const { return cancelToken && cancelToken->isCancelled(); }
+    /// true if a run goes through all regions instead of stopping at the first hit
+    bool collectsAll() const { return batch || pool; }
+    /// counts one region examined or skipped
+    void countScan(bool skipped);
+    /*! \brief calls \a scan for regions 0 .. \a count - 1 on the thread pool and queues what they found
+     * \return true if any \a scan returned true
+     */
+    bool runParallel(int count, const std::function<bool(int)>& scan);
+
     virtual bool run() = 0;
     quint8 N;
     Field& field;
-signals:
-    void started();
-    void done();
-    void applied();
-    void cellAnalyzeStarted(Cell::Ptr);
-    void cellAnalyzeFinished(Cell::Ptr);
+    TechniqueObserver* observer{nullptr};
+    bool incremental{true};
+    quint64 scans{0};
+    quint64 skips{0};
+    quint64 runs{0};
+    quint64 spentNs{0};
+    quint64 changes{0};
+    bool batch{false};
+    QThreadPool* pool{nullptr};
+    const CancelToken* cancelToken{nullptr};
+private:
+    /// findings queued instead of being applied
+    struct Batch
+    {
+        QVector<CandidateMask> removals;  // per cell
+        QVector<CellValue>     values;    // per cell, 0 if none
+        QVector<quint16>       cells;     // cells with anything queued, in queueing order
+        quint64                scans{0};
+        quint64                skips{0};
+        std::ostringstream     log;       // messages of a worker, written out when merging
+
+        void clear(qsizetype cellsCount);
+        bool eliminate(Cell::CPtr pCell, CandidateMask mask);
+        bool place(Cell::CPtr pCell, CellValue value);
+    };
+
+    bool applyBatch();
+
+    Batch              pending;
+    std::vector<Batch> workerBatches;  // one per chunk of regions of a parallel run
+    static thread_local Batch* workerBatch;  // batch of the region being scanned by this thread
 };
 
 class PerHouseTechnique: public Technique
 {
-    Q_OBJECT
 public:
-    PerHouseTechnique (Field& field, const QString& name, bool enabled = true, QObject* parent = nullptr)
-        :Technique(field, name, enabled, parent)
+    PerHouseTechnique (Field& field, const QString& name, bool enabled = true)
+        :Technique(field, name, enabled)
     {}
 protected:
     virtual bool runPerHouse(House* ) =0;
+    /// Region if runPerHouse() reads only cells of its house
+    virtual Scope scope() const { return Scope::Board; }
     bool run() final;
+private:
+    QVector<quint64> cleanBefore;  // per area: gave nothing while house change number is below this
 };
 
 class PerCellTechnique: public Technique
 {
-    Q_OBJECT
 public:
-    PerCellTechnique (Field& field, const QString& name, bool enabled = true, QObject* parent = nullptr)
-        :Technique(field, name, enabled, parent)
+    PerCellTechnique (Field& field, const QString& name, bool enabled = true)
+        :Technique(field, name, enabled)
     {}
 protected:
     virtual bool runPerCell(Cell::Ptr ) =0;
+    /// Region if runPerCell() reads only the cell itself
+    virtual Scope scope() const { return Scope::Board; }
     bool run() final;
+private:
+    QVector<quint64> cleanBefore;  // per cell: gave nothing while cell change number is below this
 };
 
 class PerCandidateTechnique: public Technique
 {
-    Q_OBJECT
 public:
-    PerCandidateTechnique(Field& field, const QString& name, bool enabled = true, QObject* parent = nullptr)
-        :Technique(field, name, enabled, parent)
+    PerCandidateTechnique(Field& field, const QString& name, bool enabled = true)
+        :Technique(field, name, enabled)
     {}
 protected:
     virtual bool runPerCandidate(CellValue candidate) = 0;
@@ -84,59 +172,74 @@ protected:
 
 class NakedSingleTechnique : public PerCellTechnique
 {
-    Q_OBJECT
 public:
-    NakedSingleTechnique(Field& field, bool enabled = true, QObject* parent = nullptr);
+    NakedSingleTechnique(Field& field, bool enabled = true);
     void setEnabled(bool enabled = true) override;
     bool canBeDisabled() const override { return false;}
+    bool isCheap() const override { return true; }
 protected:
     bool runPerCell(Cell::Ptr) override;
+    Scope scope() const override { return Scope::Region; }
+};
+
+/*! \brief naked and hidden singles in the fixed-size BasicField engine
+ *
+ * Copies the field into the BasicField instantiation for its size, runs singles
+ * to a fixpoint and writes the difference back. Does nothing for sizes without
+ * an instantiation or when the engine hits a contradiction.
+ */
+class FastSinglesTechnique : public Technique
+{
+public:
+    FastSinglesTechnique(Field& field, bool enabled = true);
+    bool isCheap() const override { return true; }
+protected:
+    bool run() override;
 };
 
 class HiddenSingleTechnique : public PerHouseTechnique
 {
-    Q_OBJECT
 protected:
     bool runPerHouse(House* house) override;
+    Scope scope() const override { return Scope::Region; }
 public:
-    HiddenSingleTechnique(Field& field, bool enabled = true, QObject* parent = nullptr);
+    HiddenSingleTechnique(Field& field, bool enabled = true);
+    bool isCheap() const override { return true; }
 };
 
 class NakedGroupTechnique : public PerHouseTechnique
 {
-    Q_OBJECT
 protected:
     bool runPerHouse(House* house) override;
+    Scope scope() const override { return Scope::Region; }
 public:
-    NakedGroupTechnique(Field& field, bool enabled = true, QObject* parent = nullptr);
+    NakedGroupTechnique(Field& field, bool enabled = true);
 };
 
 class HiddenGroupTechnique: public PerHouseTechnique
 {
-    Q_OBJECT
 protected:
     bool runPerHouse(House* house) override;
+    Scope scope() const override { return Scope::Region; }
 public:
-    HiddenGroupTechnique(Field& field, bool enabled = true, QObject* parent = nullptr);
+    HiddenGroupTechnique(Field& field, bool enabled = true);
 };
 
 
 class IntersectionsTechnique: public Technique
 {
-    Q_OBJECT
 private:
-    bool reduceIntersection(SquareHouse& square, LineHouse& area);
+    bool reduceIntersection(SquareHouse& square, LineHouse& line, const Geometry::Intersection& segment);
 public:
-    IntersectionsTechnique(Field& field, bool enabled = true, QObject* parent = nullptr);
+    IntersectionsTechnique(Field& field, bool enabled = true);
 protected:
     bool run() override;
 };
 
 class BiLocationColoringTechnique: public PerCandidateTechnique
 {
-    Q_OBJECT
 public:
-    BiLocationColoringTechnique(Field& field, bool enabled = true, QObject* parent = nullptr);
+    BiLocationColoringTechnique(Field& field, bool enabled = true);
 protected:
     bool runPerCandidate(CellValue candidate) override;
     QVector<BiLocationLink> findBiLocationLinks(CellValue val);
@@ -146,39 +249,36 @@ protected:
 
 class XWingTechnique : public Technique
 {
-    Q_OBJECT
 public:
-    XWingTechnique(Field& field, bool enabled = true, QObject* parent = nullptr);
+    XWingTechnique(Field& field, bool enabled = true);
 protected:
     bool run() override;
 };
 
 class YWingTechnique : public PerCellTechnique
 {
-    Q_OBJECT
 public:
-    YWingTechnique(Field& field, bool enabled = true, QObject* parent = nullptr);
+    YWingTechnique(Field& field, bool enabled = true);
 protected:
     bool runPerCell(Cell::Ptr) override;
 };
 
 class XYZWingTechnique: public PerCellTechnique
 {
-    Q_OBJECT
 public:
-    XYZWingTechnique(Field& field, bool enabled = true, QObject* parent = nullptr);
+    XYZWingTechnique(Field& field, bool enabled = true);
 protected:
     bool runPerCell(Cell::Ptr) override;
 };
 
 class UniqueRectangle : public PerCellTechnique
 {
-    Q_OBJECT
 
     struct Rectangle
     {
+        UniqueRectangle& technique;
         Field& field;
-        Rectangle(Field& field):field(field){}
+        Rectangle(UniqueRectangle& technique):technique(technique), field(technique.field){}
         Cell::Ptr cell              {nullptr};
         Cell::Ptr sameRowCell       {nullptr};
         Cell::Ptr sameColumnCell    {nullptr};
@@ -195,7 +295,7 @@ class UniqueRectangle : public PerCellTechnique
     };
 
 public:
-    UniqueRectangle(Field& field, bool enabled = true, QObject* parent = nullptr);
+    UniqueRectangle(Field& field, bool enabled = true);
 protected:
     bool runPerCell(Cell::Ptr) override;
 
@@ -1,5 +1,6 @@
 #include "fieldgui.h"
 #include "field.h"
+#include "guiobserver.h"
 #include <QtMath>
 
 #include <QGridLayout>
@@ -10,7 +11,7 @@
 
 #define FONT_SIZE 64
 
-FieldGui::FieldGui(Field& field, QWidget* parent)
+FieldGui::FieldGui(Field& field, GuiObserver& observer, QWidget* parent)
     :QWidget (parent)
 {
     layout = new QGridLayout(this);
@@ -31,14 +32,36 @@ FieldGui::FieldGui(Field& field, QWidget* parent)
         htitle->setAlignment(Qt::AlignCenter);
         layout->addWidget(htitle, i, 0, Qt::AlignRight | Qt::AlignVCenter);
     }
-    for (Coord coord=Coord::first(); coord.isValid(); coord++)
+    for (Coord coord=Coord::first(field.getN()); coord.isValid(); coord++)
     {
         Cell::Ptr cell = field.cell(coord);
         auto widget = new CellGui(cell, this);
         cellWidgets[cell] = widget;
         layout->addWidget(widget, coord.row(), coord.col(), Qt::AlignCenter);
-        cell->setDelay(true);
     }
+
+    connect (&observer, &GuiObserver::cellValueAboutToBeSet, this, [this](Cell::CPtr cell, CellValue)
+    {
+        cellWidgets[cell]->markValueAboutToBeSet();
+    }, Qt::QueuedConnection);
+    connect (&observer, &GuiObserver::cellValueSet, this, [this](Cell::CPtr cell, CellValue v)
+    {
+        cellWidgets[cell]->setValue(v);
+    }, Qt::QueuedConnection);
+    connect (&observer, &GuiObserver::cellCandidatesAboutToBeRemoved, this, [this](Cell::CPtr cell, CandidateMask mask)
+    {
+        cellWidgets[cell]->markCandidatesForRemoval(mask);
+    }, Qt::QueuedConnection);
+    connect (&observer, &GuiObserver::cellCandidatesRemoved, this, [this](Cell::CPtr cell, CandidateMask mask)
+    {
+        cellWidgets[cell]->removeCandidates(mask);
+    }, Qt::QueuedConnection);
+    connect (&observer, &GuiObserver::cellWasReset, this, [this](Cell::CPtr cell)
+    {
+        cellWidgets[cell]->onCellReset();
+    }, Qt::QueuedConnection);
+    connect (&observer, &GuiObserver::cellAnalyzeOn, this, &FieldGui::highlightCellOn, Qt::QueuedConnection);
+    connect (&observer, &GuiObserver::cellAnalyzeOff, this, &FieldGui::highlightCellOff, Qt::QueuedConnection);
 }
 
 void FieldGui::highlightCellOn(Cell::Ptr pCell)
@@ -125,76 +148,6 @@ CellGui::CellGui(Cell::CPtr cell, QWidget* parent)
             if (!cell->hasCandidate(bit))
                 removeCandidate(bit);
     }
-
-    connect (cell, SIGNAL(valueSet(CellValue)),         this, SLOT(setValue(CellValue)), Qt::QueuedConnection);
-    connect (cell, SIGNAL(candidateRemoved(CellValue)), this, SLOT(removeCandidate(CellValue)), Qt::QueuedConnection);
-    connect (cell, &Cell::candidateAboutToBeRemoved, this, [this](CellValue v)
-    {
-        QLabel* label = this->candidateLabel[v-1];
-
-        QPalette pal = label->palette();
-        pal.setColor(label->foregroundRole(), QColor("red"));
-        label->setPalette(pal);
-    }, Qt::QueuedConnection);
-
-    connect (cell, &Cell::candidatesRemoved, this, [this](QBitArray v)
-    {
-        for (int i=0; i<v.count(); i++)
-        {
-            if (v.testBit(i))
-            {
-                QLabel* label = this->candidateLabel[i];
-                label->setText(" ");
-            }
-        }
-    }, Qt::QueuedConnection);
-
-    connect (cell, &Cell::candidatesAboutToBeRemoved, this, [this](QBitArray v)
-    {
-        for (int i=0; i<v.count(); i++)
-        {
-            if (v.testBit(i))
-            {
-                QLabel* label = this->candidateLabel[i];
-
-                QPalette pal = label->palette();
-                pal.setColor(label->foregroundRole(), QColor("red"));
-                label->setPalette(pal);
-            }
-        }
-    }, Qt::QueuedConnection);
-
-    connect (cell, &Cell::valueAboutToBeSet, this, [this](CellValue)
-    {
-        QPalette pal = this->palette();
-        pal.setBrush(QPalette::Window, hightlightBrush);
-        this->setPalette(pal);
-    }, Qt::QueuedConnection);
-
-/*
-    connect (cell, &Cell::candidatesReset, this, [this, cell]()
-    {
-        for(int i=0; i<candidateLabel.count(); i++)
-        {
-            QLabel* candidate =  candidateLabel[i];
-            candidate->show();
-            candidate->setNum(i+1);
-            QPalette pal = candidate->palette();
-            pal.setColor(candidate->foregroundRole(), QColor("blue"));
-            candidate->setPalette(pal);
-        }
-        setText("");
-    }, Qt::QueuedConnection);
-
-    connect (cell, &Cell::valueRemoved, this, [this]()
-    {
-        setText("");
-        QPalette pal = palette();
-        pal.setColor(foregroundRole(), QColor("blue"));
-        setPalette(pal);
-    }, Qt::QueuedConnection);
-*/
-    connect(cell, &Cell::reseted, this, &CellGui::onCellReset, Qt::QueuedConnection);
 }
 
 void CellGui::highlightOn()
@@ -213,6 +166,31 @@ void CellGui::removeCandidate(CellValue bit)
     label->setText(" ");
 }
 
+void CellGui::removeCandidates(CandidateMask mask)
+{
+    for (CellValue candidate: mask)
+        removeCandidate(candidate);
+}
+
+void CellGui::markCandidatesForRemoval(CandidateMask mask)
+{
+    for (CellValue candidate: mask)
+    {
+        QLabel* label = candidateLabel[candidate-1];
+
+        QPalette pal = label->palette();
+        pal.setColor(label->foregroundRole(), QColor("red"));
+        label->setPalette(pal);
+    }
+}
+
+void CellGui::markValueAboutToBeSet()
+{
+    QPalette pal = palette();
+    pal.setBrush(QPalette::Window, hightlightBrush);
+    setPalette(pal);
+}
+
 void CellGui::onCellReset()
 {
     QPalette pal = palette();
@@ -12,6 +12,7 @@
 
 class QWidget;
 class Field;
+class GuiObserver;
 class QGridLayout;
 
 class CellGui : public QLabel
@@ -33,6 +34,9 @@ public:
 public slots:
     void setValue(CellValue );
     void removeCandidate(CellValue bit);
+    void removeCandidates(CandidateMask mask);
+    void markCandidatesForRemoval(CandidateMask mask);
+    void markValueAboutToBeSet();
     void onCellReset();
 };
 
@@ -41,9 +45,9 @@ class FieldGui : public QWidget
     Q_OBJECT
     QGridLayout* layout;
 
-    QMap<Cell::Ptr, CellGui*> cellWidgets;
+    QMap<Cell::CPtr, CellGui*> cellWidgets;
 public:
-    explicit FieldGui(Field& field, QWidget *parent = nullptr);
+    FieldGui(Field& field, GuiObserver& observer, QWidget *parent = nullptr);
 public slots:
     void highlightCellOn(Cell::Ptr );
     void highlightCellOff(Cell::Ptr );
@@ -0,0 +1,91 @@
+#include "guiobserver.h"
+
+#include <chrono>
+#include <thread>
+
+//#define DELAY_SET_VALUE
+//#define DELAY_TECHNIQUE_RUN
+
+namespace
+{
+    template<class Duration>
+    void delay(Duration d)
+    {
+        std::this_thread::sleep_until(std::chrono::steady_clock::now() + d);
+    }
+}
+
+GuiObserver::GuiObserver(QObject* parent)
+    :QObject(parent)
+{
+}
+
+void GuiObserver::valueAboutToBeSet(const Cell* cell, CellValue val)
+{
+    emit cellValueAboutToBeSet(cell, val);
+#ifdef DELAY_SET_VALUE
+    using namespace std::chrono_literals;
+    delay(100ms);
+#endif
+}
+
+void GuiObserver::valueSet(const Cell* cell, CellValue val)
+{
+#ifdef DELAY_SET_VALUE
+    using namespace std::chrono_literals;
+    delay(100ms);
+#endif
+    emit cellValueSet(cell, val);
+}
+
+void GuiObserver::candidatesAboutToBeRemoved(const Cell* cell, CandidateMask mask)
+{
+    emit cellCandidatesAboutToBeRemoved(cell, mask);
+#ifdef DELAY_SET_VALUE
+    using namespace std::chrono_literals;
+    delay(500ms);
+#endif
+}
+
+void GuiObserver::candidatesRemoved(const Cell* cell, CandidateMask mask)
+{
+    emit cellCandidatesRemoved(cell, mask);
+#ifdef DELAY_SET_VALUE
+    using namespace std::chrono_literals;
+    delay(50ms);
+#endif
+}
+
+void GuiObserver::cellReset(const Cell* cell)
+{
+    emit cellWasReset(cell);
+}
+
+void GuiObserver::techniqueStarted(const Technique* tech)
+{
+    emit started(tech);
+#ifdef DELAY_TECHNIQUE_RUN
+    using namespace std::chrono_literals;
+    delay(100ms);
+#endif
+}
+
+void GuiObserver::techniqueDone(const Technique* tech)
+{
+    emit done(tech);
+}
+
+void GuiObserver::techniqueApplied(const Technique* tech)
+{
+    emit applied(tech);
+}
+
+void GuiObserver::cellAnalyzeStarted(const Technique*, Cell* cell)
+{
+    emit cellAnalyzeOn(cell);
+}
+
+void GuiObserver::cellAnalyzeFinished(const Technique*, Cell* cell)
+{
+    emit cellAnalyzeOff(cell);
+}
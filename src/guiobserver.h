@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QObject>
+
+#include "cell.h"
+#include "observer.h"
+#include "technique.h"
+
+/*! \brief Bridges solver callbacks to Qt signals
+ *
+ * Attached to a Field and a Resolver, it re-emits every callback as a signal, so
+ * widgets can connect with Qt::QueuedConnection while the solver runs in its own
+ * thread. The delays used to animate the solving process live here too.
+ */
+class GuiObserver : public QObject, public CellObserver, public TechniqueObserver
+{
+    Q_OBJECT
+public:
+    explicit GuiObserver(QObject* parent = nullptr);
+
+    void valueAboutToBeSet(const Cell* cell, CellValue val) override;
+    void valueSet(const Cell* cell, CellValue val) override;
+    void candidatesAboutToBeRemoved(const Cell* cell, CandidateMask mask) override;
+    void candidatesRemoved(const Cell* cell, CandidateMask mask) override;
+    void cellReset(const Cell* cell) override;
+
+    void techniqueStarted(const Technique* tech) override;
+    void techniqueDone(const Technique* tech) override;
+    void techniqueApplied(const Technique* tech) override;
+    void cellAnalyzeStarted(const Technique* tech, Cell* cell) override;
+    void cellAnalyzeFinished(const Technique* tech, Cell* cell) override;
+
+signals:
+    void cellValueAboutToBeSet(Cell::CPtr, CellValue);
+    void cellValueSet(Cell::CPtr, CellValue);
+    void cellCandidatesAboutToBeRemoved(Cell::CPtr, CandidateMask);
+    void cellCandidatesRemoved(Cell::CPtr, CandidateMask);
+    void cellWasReset(Cell::CPtr);
+
+    void started(const Technique*);
+    void done(const Technique*);
+    void applied(const Technique*);
+    void cellAnalyzeOn(Cell::Ptr);
+    void cellAnalyzeOff(Cell::Ptr);
+};
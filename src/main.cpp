@@ -11,18 +11,28 @@
 #include <QBoxLayout>
 #include <QCheckBox>
 #include <QCommandLineParser>
+#include <QDeadlineTimer>
 #include <QDialog>
 #include <QElapsedTimer>
+#include <QFileInfo>
 #include <QGroupBox>
 #include <QPushButton>
 
+#include "basicfield.h"
 #include "field.h"
 #include "fieldgui.h"
+#include "guiobserver.h"
+#include "log.h"
+#include "packedcorpus.h"
 #include "resolver.h"
+#include "solvetrace.h"
 
 int main (int argc, char* argv[])
 {
     qRegisterMetaType<CellValue>("CellValue");
+    qRegisterMetaType<CandidateMask>("CandidateMask");
+    qRegisterMetaType<Cell::CPtr>("Cell::CPtr");
+    qRegisterMetaType<const Technique*>("const Technique*");
     QApplication app(argc, argv);
     QCoreApplication::setApplicationName("QSudokuSolver");
     QCoreApplication::setApplicationVersion("1.1");
@@ -39,6 +49,38 @@ int main (int argc, char* argv[])
         "Use text interface");
     parser.addOption(noGuiOption);
 
+    QCommandLineOption logLevelOption("log-level", "Solver trace: off, summary, info or trace", "level", "summary");
+    parser.addOption(logLevelOption);
+
+    QCommandLineOption traceOption(
+        "trace", "Record solve steps into binary <file> (text interface only), with technique explanations at --log-level info or trace", "file");
+    parser.addOption(traceOption);
+    QCommandLineOption replayOption("replay", "Print steps recorded in binary trace <file> and exit", "file");
+    parser.addOption(replayOption);
+    QCommandLineOption searchOption("search", "Finish with backtracking search when techniques make no more progress");
+    parser.addOption(searchOption);
+    QCommandLineOption fullRescanOption("full-rescan", "Let techniques rescan every cell and house, also unchanged ones");
+    parser.addOption(fullRescanOption);
+    QCommandLineOption batchOption("batch", "Let each technique apply everything it finds on the current state at once");
+    parser.addOption(batchOption);
+    QCommandLineOption threadsOption("threads", "Spread per-cell and per-house techniques over <n> threads", "n", "1");
+    parser.addOption(threadsOption);
+    QCommandLineOption scheduleOption("schedule", "Technique order: fixed (registration order) or adaptive (by measured yield)", "policy", "fixed");
+    parser.addOption(scheduleOption);
+    QCommandLineOption countOption("count-solutions", "Count solutions instead of solving; exit code 0 if the puzzle is unique, 2 otherwise");
+    parser.addOption(countOption);
+    QCommandLineOption limitOption("solution-limit", "Stop counting after <n> solutions", "n", "2");
+    parser.addOption(limitOption);
+    QCommandLineOption timeoutOption("timeout", "Give up counting or solving after <ms> milliseconds", "ms");
+    parser.addOption(timeoutOption);
+    QCommandLineOption packOption("pack", "Convert all puzzles of the .sdm or .fsdm file into packed binary corpus <target> and exit", "target");
+    parser.addOption(packOption);
+    QCommandLineOption packSolutionsOption("pack-solutions", "With --pack, also store solutions and search node counts as ratings");
+    parser.addOption(packSolutionsOption);
+    QCommandLineOption classicSinglesOption("classic-singles",
+                                            "Find singles cell by cell and house by house instead of in the fixed-size engine for 9x9, 16x16 and 25x25");
+    parser.addOption(classicSinglesOption);
+
     parser.addOptions({
         {"no-hidden-single",        "Disable Hidden Single technique"       },
         {"no-naked-group",          "Disable Naked Group technique"         },
@@ -53,10 +95,51 @@ int main (int argc, char* argv[])
 
     parser.process(app);
 
+    bool logLevelOk = false;
+    Log::setLevel(Log::levelFromName(parser.value(logLevelOption), &logLevelOk));
+    if ( !logLevelOk ) {
+        std::cerr << "unknown log level " << qPrintable(parser.value(logLevelOption)) << std::endl;
+        parser.showHelp(1);
+        Q_UNREACHABLE( );
+    }
+
+    if ( parser.isSet(replayOption) ) {
+        SolveTrace trace;
+        if ( !trace.load(parser.value(replayOption)) ) {
+            std::cerr << "unable to read trace " << qPrintable(parser.value(replayOption)) << std::endl;
+            return 1;
+        }
+        Field field;
+        const bool replayed = trace.replay(field, std::cout);
+        std::cout << field << std::endl;
+        if ( !replayed ) {
+            std::cerr << "trace does not match the recorded field" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
     int  plainTextInputFileLineNum = 1;
     bool noGui                     = false;
     noGui                          = parser.isSet(noGuiOption);
     QStringList args               = parser.positionalArguments( );
+
+    if ( parser.isSet(packOption) ) {
+        if ( args.isEmpty( ) ) {
+            std::cerr << "file to convert is missing. Exiting";
+            parser.showHelp(1);
+            Q_UNREACHABLE( );
+        }
+        const quint8 contents = parser.isSet(packSolutionsOption) ? PackedCorpus::Solutions | PackedCorpus::Ratings : PackedCorpus::Givens;
+        const qint64 packed   = PackedCorpusWriter::convert(args.at(0), parser.value(packOption), contents);
+        if ( packed < 0 ) {
+            std::cerr << "unable to convert " << qPrintable(args.at(0)) << std::endl;
+            return 1;
+        }
+        std::cout << packed << " puzzles packed into " << qPrintable(parser.value(packOption)) << std::endl;
+        return 0;
+    }
+
     if ( args.size( ) != 2 ) {
         std::cerr << "filename or linenumber is missing. Exiting";
         parser.showHelp(1);
@@ -66,15 +149,63 @@ int main (int argc, char* argv[])
     QString filename          = args.at(0);
     plainTextInputFileLineNum = args.at(1).toInt( );
 
+    qint64 timeout = -1;
+    if ( parser.isSet(timeoutOption) ) {
+        bool timeoutOk = false;
+        timeout        = parser.value(timeoutOption).toLongLong(&timeoutOk);
+        if ( !timeoutOk || timeout <= 0 ) {
+            std::cerr << "timeout must be a positive number of milliseconds" << std::endl;
+            return 1;
+        }
+    }
+
+    // packed corpora are read in place, anything else as plain text
+    auto readPuzzle = [&filename, plainTextInputFileLineNum] (Field& field) {
+        if ( QFileInfo(filename).suffix( ) != "sdpk" )
+            return field.readFromPlainTextFile(filename, plainTextInputFileLineNum);
+        PackedCorpus corpus;
+        return corpus.open(filename) && corpus.loadPuzzle(plainTextInputFileLineNum, field);
+    };
+
     Field field;
-    if ( !field.readFromPlainTextFile(filename, plainTextInputFileLineNum) || !field.isValid( ) ) {
+    if ( !readPuzzle(field) || !field.isValid( ) ) {
         std::cerr << "Invalid sudoku read" << std::endl;
         return 1;
     }
 
+    if ( parser.isSet(countOption) ) {
+        bool          limitOk = false;
+        const quint64 limit   = parser.value(limitOption).toULongLong(&limitOk);
+        if ( !limitOk || limit == 0 ) {
+            std::cerr << "solution limit must be a positive number" << std::endl;
+            return 1;
+        }
+        QDeadlineTimer deadline(QDeadlineTimer::Forever);
+        if ( timeout > 0 )
+            deadline.setRemainingTime(timeout);
+
+        const SolutionCount result = field.countSolutions(limit, deadline);
+        std::cout << qPrintable(filename) << "[" << plainTextInputFileLineNum << "] has " << result.solutions;
+        if ( result.timedOut )
+            std::cout << " or more solutions, timed out";
+        else if ( result.solutions == limit )
+            std::cout << " or more solutions";
+        else
+            std::cout << (result.solutions == 1 ? " solution" : " solutions");
+        std::cout << " (" << result.nodes << " nodes)" << std::endl;
+        return result.isUnique( ) && limit > 1 ? 0 : 2;
+    }
+
     Resolver resolver(field);
-    resolver.registerTechnique<NakedSingleTechnique>( );
-    resolver.registerTechnique<HiddenSingleTechnique>( )->setEnabled(!parser.isSet("no-hidden-single"));
+    // the engine finds hidden singles too, so it cannot honour --no-hidden-single
+    const bool fastSingles = !parser.isSet(classicSinglesOption) && !parser.isSet("no-hidden-single")
+                          && withBasicField(field.getN( ), [] (auto&) { return true; });
+    if ( fastSingles )
+        resolver.registerTechnique<FastSinglesTechnique>( );
+    else {
+        resolver.registerTechnique<NakedSingleTechnique>( );
+        resolver.registerTechnique<HiddenSingleTechnique>( )->setEnabled(!parser.isSet("no-hidden-single"));
+    }
     resolver.registerTechnique<NakedGroupTechnique>( )->setEnabled(!parser.isSet("no-naked-group"));
     resolver.registerTechnique<HiddenGroupTechnique>( )->setEnabled(!parser.isSet("no-hidden-group"));
     resolver.registerTechnique<IntersectionsTechnique>( )->setEnabled(!parser.isSet("no-intersections"));
@@ -83,14 +214,40 @@ int main (int argc, char* argv[])
     resolver.registerTechnique<YWingTechnique>( )->setEnabled(!parser.isSet("no-ywing"));
     resolver.registerTechnique<XYZWingTechnique>( )->setEnabled(!parser.isSet("no-xyzwing"));
     resolver.registerTechnique<UniqueRectangle>( )->setEnabled(!parser.isSet("unique-rectangle"));
+    resolver.setSearchEnabled(parser.isSet(searchOption));
+    resolver.setIncremental(!parser.isSet(fullRescanOption));
+    resolver.setBatch(parser.isSet(batchOption));
+    bool      threadsOk = false;
+    const int threads   = parser.value(threadsOption).toInt(&threadsOk);
+    if ( !threadsOk || threads < 1 ) {
+        std::cerr << "thread count must be a positive number" << std::endl;
+        return 1;
+    }
+    resolver.setThreadCount(threads);
+    if ( timeout > 0 )
+        resolver.setTimeLimit(timeout);
+    if ( parser.value(scheduleOption) == "adaptive" )
+        resolver.setSchedule(Resolver::Schedule::Adaptive);
+    else if ( parser.value(scheduleOption) != "fixed" ) {
+        std::cerr << "unknown schedule " << qPrintable(parser.value(scheduleOption)) << std::endl;
+        parser.showHelp(1);
+        Q_UNREACHABLE( );
+    }
 
     if ( noGui ) {
+        SolveTrace trace;
+        if ( parser.isSet(traceOption) )
+            resolver.setTrace(&trace);
+
         qint64        elaps;
         QElapsedTimer timer;
         timer.start( );
         resolver.process( );
         elaps = timer.elapsed( );
 
+        if ( parser.isSet(traceOption) && !trace.save(parser.value(traceOption)) )
+            std::cerr << "unable to write trace " << qPrintable(parser.value(traceOption)) << std::endl;
+
         std::cout << field << std::endl;
 
         std::cout << qPrintable(filename) << "[" << plainTextInputFileLineNum << "] Done in " << elaps << " ms and is ";
@@ -98,13 +255,25 @@ int main (int argc, char* argv[])
             std::cout << "resolved" << std::endl;
         else if ( !field.isValid( ) )
             std::cout << "is INVALID" << std::endl;
+        else if ( resolver.stats( ).timedOut )
+            std::cout << "timed out" << std::endl;
         else if ( field.hasEmptyValues( ) )
             std::cout << "NOT resolved" << std::endl;
+        std::cout << "passes " << resolver.stats( ).iterations << ", regions scanned " << resolver.stats( ).regionScans << ", skipped as unchanged "
+                  << resolver.stats( ).regionsSkipped << std::endl;
+        if ( resolver.stats( ).searched )
+            std::cout << "techniques left " << resolver.stats( ).logicalUnresolved << " cells after "
+                      << resolver.stats( ).logicalSteps << " steps, search visited " << resolver.stats( ).searchNodes
+                      << " nodes" << std::endl;
 
         return 0;
     }
+    GuiObserver observer;
+    field.setCellObserver(&observer);
+    resolver.setTechniqueObserver(&observer);
+
     QDialog     diag;
-    FieldGui    fgui_before(field, &diag);
+    FieldGui    fgui_before(field, observer, &diag);
     QPushButton goButton("Go", &diag);
     QPushButton reloadButton("Reload", &diag);
     QString     windowTitle = QString("Sudoku [%1: %2]").arg(filename).arg(plainTextInputFileLineNum);
@@ -127,16 +296,20 @@ int main (int argc, char* argv[])
         },
             Qt::QueuedConnection);
         QApplication::connect(
-            tech, &Technique::started, pCheck,
-            [pCheck] ( ) {
+            &observer, &GuiObserver::started, pCheck,
+            [tech, pCheck] (const Technique* t) {
+            if ( t != tech )
+                return;
             QFont font = pCheck->font( );
             font.setBold(true);
             pCheck->setFont(font);
         },
             Qt::QueuedConnection);
         QApplication::connect(
-            tech, &Technique::done, pCheck,
-            [pCheck] ( ) {
+            &observer, &GuiObserver::done, pCheck,
+            [tech, pCheck] (const Technique* t) {
+            if ( t != tech )
+                return;
             QFont font = pCheck->font( );
             font.setBold(false);
             pCheck->setFont(font);
@@ -147,8 +320,10 @@ int main (int argc, char* argv[])
         },
             Qt::QueuedConnection);
         QApplication::connect(
-            tech, &Technique::applied, pCheck,
-            [pCheck] ( ) {
+            &observer, &GuiObserver::applied, pCheck,
+            [tech, pCheck] (const Technique* t) {
+            if ( t != tech )
+                return;
             QFont font = pCheck->font( );
             font.setBold(false);
             pCheck->setFont(font);
@@ -166,9 +341,6 @@ int main (int argc, char* argv[])
             pCheck->setPalette(pal);
         },
             Qt::QueuedConnection);
-
-        QApplication::connect(tech, &Technique::cellAnalyzeStarted, &fgui_before, &FieldGui::highlightCellOn, Qt::QueuedConnection);
-        QApplication::connect(tech, &Technique::cellAnalyzeFinished, &fgui_before, &FieldGui::highlightCellOff, Qt::QueuedConnection);
     }
 
     layout.addWidget(&fgui_before);
@@ -204,8 +376,8 @@ int main (int argc, char* argv[])
         goButton.setEnabled(true);
     },
         Qt::QueuedConnection);
-    QApplication::connect(&reloadButton, &QPushButton::pressed, [filename, plainTextInputFileLineNum, &field] ( ) {
-        field.readFromPlainTextFile(filename, plainTextInputFileLineNum);
+    QApplication::connect(&reloadButton, &QPushButton::pressed, [readPuzzle, &field] ( ) {
+        readPuzzle(field);
     });
     QApplication::connect(&app, &QApplication::aboutToQuit, &resolver, &Resolver::stop);
 
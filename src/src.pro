@@ -1,6 +1,6 @@
 QT += gui widgets concurrent
 
-CONFIG += c++17 console
+CONFIG += c++20 console
 CONFIG -= app_bundle
 
 TARGET = sudoku
@@ -14,6 +14,9 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 DEFINES += INVALID_COORD_EXCEPTION
 
+DEFINES += _DELAY_SET_VALUE \
+		  _DELAY_TECHNIQUE_RUN
+
 # You can also make your code fail to compile if you use deprecated APIs.
 # In order to do so, uncomment the following line.
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
@@ -21,7 +24,8 @@ DEFINES += INVALID_COORD_EXCEPTION
 
 SOURCES += \
 		main.cpp \
-		fieldgui.cpp
+		fieldgui.cpp \
+		guiobserver.cpp
 
 LIBS += -L../bin -lsudoku
 unix:QMAKE_LFLAGS += "-Wl,-rpath,\'\$$ORIGIN\'"
@@ -33,13 +37,13 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 
 unix {
     QMAKE_CXXFLAGS += -Wall -Wpedantic
-    LIBS += -lgsl -lgslcblas
 }
 
 INCLUDEPATH += ../libsudoku
 
 HEADERS += \
-	fieldgui.h
+	fieldgui.h \
+	guiobserver.h
 
 OBJECTS_DIR = .obj
 UI_DIR = .ui
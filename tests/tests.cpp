@@ -3,7 +3,18 @@
 #include "coord.h"
 #include "field.h"
 #include "resolver.h"
+#include "basicfield.h"
+#include "bitboardsolver.h"
+#include "canceltoken.h"
+#include "celltrail.h"
+#include "dlxsolver.h"
+#include "log.h"
+#include "packedcorpus.h"
+#include "puzzlecorpus.h"
+#include "solvetrace.h"
 #include <QtGlobal>
+#include <limits>
+#include <sstream>
 #if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
 #   include <QRandomGenerator>
 #endif
@@ -16,9 +27,39 @@ public:
     CommonTest() = default;
 
 private:
-    using TechTestCandidatesParams = std::list<std::pair<Coord, std::list<CellValue>>>;
-    using TechTestValuesParams = std::list<std::pair<Coord, CellValue>>;
+    using CellPos = std::pair<quint8, quint8>;
+    using TechTestCandidatesParams = std::list<std::pair<CellPos, std::list<CellValue>>>;
+    using TechTestValuesParams = std::list<std::pair<CellPos, CellValue>>;
 
+    static Coord coordOf(const Field& field, const CellPos& pos) { return Coord(pos.first, pos.second, field.getN()); }
+
+    static QVector<CellValue> values(const Field& field)
+    {
+        QVector<CellValue> ret;
+        for (Coord coord = Coord::first(field.getN()); coord.isValid(); coord++)
+            ret.append(field.cell(coord)->value());
+        return ret;
+    }
+
+    /// every technique; group ones crawl on 25x25, \a groups = false leaves them disabled
+    static void registerAllTechniques(Resolver& resolver, bool groups = true, bool fastSingles = false)
+    {
+        if (fastSingles)
+            resolver.registerTechnique<FastSinglesTechnique>();
+        else
+        {
+            resolver.registerTechnique<NakedSingleTechnique>();
+            resolver.registerTechnique<HiddenSingleTechnique>();
+        }
+        resolver.registerTechnique<NakedGroupTechnique>()->setEnabled(groups);
+        resolver.registerTechnique<HiddenGroupTechnique>()->setEnabled(groups);
+        resolver.registerTechnique<IntersectionsTechnique>();
+        resolver.registerTechnique<BiLocationColoringTechnique>();
+        resolver.registerTechnique<XWingTechnique>();
+        resolver.registerTechnique<YWingTechnique>();
+        resolver.registerTechnique<XYZWingTechnique>();
+        resolver.registerTechnique<UniqueRectangle>();
+    }
 
     /*! \brief Checks candidates are removed*/
     template<class TECH>
@@ -32,7 +73,7 @@ private:
         {
             for (auto a: c.second)
             {
-                QCOMPARE(field.cell(c.first)->hasCandidate(a), true);
+                QCOMPARE(field.cell(coordOf(field, c.first))->hasCandidate(a), true);
             }
         }
         if (itertionsNum == 0)
@@ -45,7 +86,7 @@ private:
         {
             for (auto a: c.second)
             {
-                QCOMPARE(field.cell(c.first)->hasCandidate(a), false);
+                QCOMPARE(field.cell(coordOf(field, c.first))->hasCandidate(a), false);
             }
         }
     }
@@ -60,7 +101,7 @@ private:
 
         for(auto c: list)
         {
-                QVERIFY(field.cell(c.first)->value() == 0);
+                QVERIFY(field.cell(coordOf(field, c.first))->value() == 0);
         }
         if (itertionsNum == 0)
             while (tech.perform());
@@ -70,7 +111,7 @@ private:
 
         for(auto c: list)
         {
-                QVERIFY(field.cell(c.first)->value() == c.second);
+                QVERIFY(field.cell(coordOf(field, c.first))->value() == c.second);
         }
     }
 //private slots:
@@ -82,11 +123,17 @@ private:
     void Coord_initialization_tests();
     void Coord_getters_tests();
     void Coord_operation_tests();
-    void Coord_same_house_tests();
+    void Geometry_peers_tests();
+    void Geometry_intersections_test();
 
     void Cell_test_candidates();
+    void CandidateCombinations_test();
     void Cell_test_removeCandidate();
     void Cell_setValue_test();
+    void Field_candidate_planes_test();
+    void Field_observer_test();
+    void Log_levels_test();
+    void CellSet_operations_test();
 
     // Low-level technique tests (1 iteration)
     void naked_single_tech_test();
@@ -101,10 +148,58 @@ private:
     void ywing_solve_test();
     void unique_rectangle_solve_tests();
     void coloring_solve_test();
+    void concurrent_solve_test();
+    void solve_trace_replay_test();
+    void solve_trace_search_test();
+    void fast_singles_test();
+    void search_fallback_test();
+    void dlx_solver_test();
+    void bitboard_solver_test();
+    void count_solutions_test();
+    void incremental_scan_test();
+    void adaptive_schedule_test();
+    void batch_elimination_test();
+    void parallel_techniques_test();
+    void cancellation_test();
+    void snapshot_restore_test();
+    void trail_undo_test();
+    void field_reuse_test();
+    void puzzle_corpus_test();
+    void packed_corpus_test();
 
     // Benchmarks
     void benchmark9x9();
     void benchmark16x16();
+    void benchmark25x25();
+    void benchmarkParallel16x16_data();
+    void benchmarkParallel16x16();
+    void benchmarkParallel25x25_data();
+    void benchmarkParallel25x25();
+    void benchmarkDlx16x16();
+    void benchmarkDlx25x25();
+    void benchmarkLearningCurve();
+    void benchmarkLearningCurveAdaptive();
+    void benchmarkCancelPolling_data();
+    void benchmarkCancelPolling();
+    void benchmarkSnapshotRestore_data();
+    void benchmarkSnapshotRestore();
+    void benchmarkTrailUndo();
+    void benchmarkLoadPuzzle_data();
+    void benchmarkLoadPuzzle();
+    void benchmarkCorpusAccess_data();
+    void benchmarkCorpusAccess();
+    void benchmarkPackedCorpus_data();
+    void benchmarkPackedCorpus();
+    void benchmarkLogLevels_data();
+    void benchmarkLogLevels();
+    void benchmarkCandidateMask();
+    void benchmarkDynamicSingles();
+    void benchmarkFastSingles();
+    void benchmarkBitboard9x9();
+    void benchmarkCountSolutions();
+    void benchmarkCellSetUnion();
+    void benchmarkCellSetDifference();
+    void benchmarkCellSetIntersection();
 };
 
 
@@ -118,24 +213,23 @@ void CommonTest::cleanupTestCase()
 
 void CommonTest::init()
 {
-    Coord::init(9);
 }
 
 void CommonTest::Coord_initialization_tests()
 {
-    Coord coord(5,7);
+    Coord coord(5,7,9);
     QVERIFY(coord.isValid());
 
-    Coord coord_wrong_row(0,1);
+    Coord coord_wrong_row(0,1,9);
     QVERIFY(!coord_wrong_row.isValid());
 
-    Coord coord_wrong_col(1,0);
+    Coord coord_wrong_col(1,0,9);
     QVERIFY(!coord_wrong_col.isValid());
 }
 
 void CommonTest::Coord_getters_tests()
 {
-    Coord coord(5,7);
+    Coord coord(5,7,9);
     QVERIFY(coord.row() == 5);
     QVERIFY(coord.col() == 7);
     QVERIFY(coord.isValid());
@@ -153,12 +247,12 @@ void CommonTest::Coord_getters_tests()
     QVERIFY(coord.col() == 7);
     QVERIFY(coord.row() == 3);
 
-    QVERIFY(Coord::last().rawIndex() == Coord::maxRawIndex());
+    QVERIFY(Coord::last(9).rawIndex() == coord.maxRawIndex());
 }
 
 void CommonTest::Coord_operation_tests()
 {
-    Coord coord(1,2);
+    Coord coord(1,2,9);
     coord++;
     QVERIFY(coord.row() == 1);
     QVERIFY(coord.col() == 3);
@@ -168,39 +262,117 @@ void CommonTest::Coord_operation_tests()
     QVERIFY(coord.row() == 2);
     QVERIFY(coord.col() == 1);
 
-    coord = Coord::last();
-    QVERIFY(coord == Coord::last());
+    coord = Coord::last(9);
+    QVERIFY(coord == Coord::last(9));
 
     coord++;
     QVERIFY(!coord.isValid());
 
-    Coord coordA(1,2);
-    Coord coordB(2,1);
+    Coord coordA(1,2,9);
+    Coord coordB(2,1,9);
     QVERIFY(coordA < coordB);
     QVERIFY(coordB > coordA);
     QVERIFY(coordA != coordB);
 }
 
-void CommonTest::Coord_same_house_tests()
+void CommonTest::Geometry_peers_tests()
 {
-    Coord c;
+    Geometry geometry(9);
+    QVERIFY(geometry.squareSize() == 3);
+
+    Coord c(5,7,9);
+    quint16 idx = c.rawIndex();
+    QVERIFY(geometry.row(idx) == 4);
+    QVERIFY(geometry.column(idx) == 6);
+    QVERIFY(geometry.square(idx) == c.squareIdx());
+
+    QVERIFY(geometry.peers(idx).size() == 20);
+    QVERIFY(geometry.peerMask(idx).count() == 20);
+    QVERIFY(!geometry.peerMask(idx).test(idx));
+    for (quint16 other = 0; other < 81; other++)
+    {
+        Coord o = Coord::fromRawIndex(other, 9);
+        bool visible = other != idx && (o.row() == c.row() || o.col() == c.col() || o.squareIdx() == c.squareIdx());
+        QVERIFY(geometry.sees(idx, other) == visible);
+    }
 
-    c.setRowCol(1,1);
+    for (quint8 i=1;i<=9;i++)
+    {
+        QVERIFY(geometry.rowCells(4)[i-1] == Coord(5, i, 9).rawIndex());
+        QVERIFY(geometry.columnCells(6)[i-1] == Coord(i, 7, 9).rawIndex());
+    }
 
-    QVector<Coord> sameHouse = c.sameColumnCoordinates();
-    for(quint8 i=1;i<=9;i++)
-        if (i!=c.row())
-            QVERIFY(sameHouse.contains(Coord(i,c.col())));
-        else
-            QVERIFY(!sameHouse.contains(Coord(i, c.col())));
+    Geometry big(25);
+    QVERIFY(big.peers(0).size() == 3 * 25 - 2 * 5 - 1);
+    QVERIFY_THROWS_EXCEPTION(std::out_of_range, Geometry(10));
+}
 
-    sameHouse = c.sameRowCoordinates();
-    for(quint8 i=1;i<=9;i++)
-        if (i!=c.col())
-            QVERIFY(sameHouse.contains(Coord(c.row(), i)));
-        else
-            QVERIFY(!sameHouse.contains(Coord(c.row(), i)));
+void CommonTest::Geometry_intersections_test()
+{
+    for (quint8 n: {4, 9, 16})
+    {
+        Geometry geometry(n);
+        QCOMPARE(geometry.intersections().size(), static_cast<size_t>(2 * n * geometry.squareSize()));
+        for (const Geometry::Intersection& segment: geometry.intersections())
+        {
+            std::span<const quint16> line = segment.isRow ? geometry.rowCells(segment.line) : geometry.columnCells(segment.line);
+            std::span<const quint16> square = geometry.squareCells(segment.square);
+            const CellBitSet lineMask = segment.isRow ? geometry.rowMask(segment.line) : geometry.columnMask(segment.line);
+            const CellBitSet common = lineMask & geometry.squareMask(segment.square);
+            QCOMPARE(common.count(), static_cast<int>(geometry.squareSize()));
+            for (quint8 k = 0; k < n; k++)
+            {
+                QCOMPARE(static_cast<bool>((segment.inSquare >> k) & 1), common.test(square[k]));
+                QCOMPARE(static_cast<bool>((segment.restOfSquare >> k) & 1), !common.test(square[k]));
+                QCOMPARE(static_cast<bool>((segment.inLine >> k) & 1), common.test(line[k]));
+                QCOMPARE(static_cast<bool>((segment.restOfLine >> k) & 1), !common.test(line[k]));
+            }
+        }
+    }
+}
 
+void CommonTest::CandidateCombinations_test()
+{
+    auto binomial = [](int n, int k)
+    {
+        quint64 ret = 1;
+        for (int i = 1; i <= k; i++)
+            ret = ret * (n - k + i) / i;
+        return ret;
+    };
+
+    for (quint8 n: {4, 9, 16})
+    {
+        quint64 expected = 0;
+        for (int k = 2; k <= n / 2; k++)
+            expected += binomial(n, k);
+
+        quint64 count = 0;
+        CandidateMask previous;
+        for (CandidateMask mask: CandidateCombinations(n, 2, n / 2))
+        {
+            QVERIFY(mask.count() >= 2 && mask.count() <= n / 2);
+            QVERIFY(mask.isSubsetOf(CandidateMask::all(n)));
+            // ordered by size, then by value
+            QVERIFY(count == 0 || previous.count() < mask.count() || previous.raw() < mask.raw());
+            previous = mask;
+            count++;
+        }
+        QCOMPARE(count, expected);
+    }
+
+    // capped by unresolved cells of a house
+    Field field;
+    QVERIFY(field.readFromPlainTextFile("../puzzle/learningcurve.sdm", 0));
+    int count = 0;
+    for (CandidateMask mask: field.candidatesCombinations(2))
+    {
+        QCOMPARE(mask.count(), 2);
+        count++;
+    }
+    QCOMPARE(count, 36);
+    QVERIFY(field.candidatesCombinations(1).isEmpty());
+    QVERIFY(field.candidatesCombinations(-1).begin() == field.candidatesCombinations(-1).end());
 }
 
 void CommonTest::Cell_test_candidates()
@@ -219,12 +391,22 @@ void CommonTest::Cell_test_candidates()
     QVERIFY_THROWS_EXCEPTION(std::out_of_range, cell->hasCandidate(0));
     QVERIFY_THROWS_EXCEPTION(std::out_of_range, cell->hasCandidate(10));
 
-    QBitArray evenBits(9);
-    evenBits.setBit(1);
-    evenBits.setBit(3);
-    evenBits.setBit(5);
-    evenBits.setBit(7);
+    CandidateMask evenBits;
+    evenBits.setCandidate(2);
+    evenBits.setCandidate(4);
+    evenBits.setCandidate(6);
+    evenBits.setCandidate(8);
     QVERIFY(cell->hasAnyOfCandidates(evenBits));
+    QCOMPARE(cell->hasAnyOfCandidates(evenBits), 4);
+    QVERIFY(!cell->candidatesExactMatch(evenBits));
+    std::ostringstream printed;
+    printed << evenBits << CandidateMask() << (CandidateMask::single(1) | CandidateMask::single(12));
+    QCOMPARE(printed.str(), std::string("{2,4,6,8}{}{1,12}"));
+
+    cell->removeCandidate(evenBits);
+    QCOMPARE(cell->candidatesCount(), 5);
+    QVERIFY(cell->candidatesExactMatch(~evenBits));
+    QCOMPARE(cell->candidates(), QVector<CellValue>({1, 3, 5, 7, 9}));
 
     QVERIFY(!cell->isResolved());
 }
@@ -292,6 +474,196 @@ void CommonTest::Cell_setValue_test()
     }
 }
 
+void CommonTest::Field_candidate_planes_test()
+{
+    Field field;
+    QVERIFY(field.readFromPlainTextFile("../puzzle/coloring.sdm", 0));
+
+    auto verifyPlanes = [&field]() -> bool
+    {
+        const CandidatePlanes& planes = field.candidatePlanes();
+        for (Coord coord = Coord::first(field.getN()); coord.isValid(); coord++)
+        {
+            Cell::CPtr pCell = field.cell(coord);
+            if (planes.solvedCells().test(coord.rawIndex()) != pCell->isResolved())
+                return false;
+            const quint8 n = field.getN();
+            const quint8 s = Coord::squareSizeFor(n);
+            const quint8 row = coord.row() - 1;
+            const quint8 col = coord.col() - 1;
+            const quint8 posInSquare = (row % s) * s + col % s;
+            for (CellValue v = 1; v <= n; v++)
+            {
+                const bool expected = !pCell->isResolved() && pCell->hasCandidate(v);
+                if (planes.digit(v).test(coord.rawIndex()) != expected)
+                    return false;
+                // houses are numbered rows, columns, squares
+                if (((planes.housePositions(row, v) >> col) & 1) != expected
+                    || ((planes.housePositions(n + col, v) >> row) & 1) != expected
+                    || ((planes.housePositions(2 * n + coord.squareIdx(), v) >> posInSquare) & 1) != expected)
+                    return false;
+            }
+        }
+        return true;
+    };
+    QVERIFY(verifyPlanes());
+
+    NakedSingleTechnique nakedSingle(field);
+    IntersectionsTechnique intersections(field);
+    while (nakedSingle.perform() || intersections.perform());
+    QVERIFY(verifyPlanes());
+
+    for (CellValue v = 1; v <= field.getN(); v++)
+    {
+        int expected = 0;
+        for (quint8 col = 1; col <= field.getN(); col++)
+        {
+            Cell::CPtr pCell = field.cell(Coord(5, col, field.getN()));
+            if (!pCell->isResolved() && pCell->hasCandidate(v))
+                expected++;
+        }
+        CellSet row5;
+        for (quint8 col = 1; col <= field.getN(); col++)
+            row5.addCell(field.cell(Coord(5, col, field.getN())));
+        QCOMPARE(field.candidatePositions(row5, v).count(), expected);
+    }
+}
+
+void CommonTest::Field_observer_test()
+{
+    struct Recorder : CellObserver, TechniqueObserver
+    {
+        int valuesSet {0};
+        int removed {0};
+        int started {0};
+        int finished {0};
+        int analyzeStarted {0};
+        int analyzeFinished {0};
+
+        void valueSet(const Cell*, CellValue) override { valuesSet++; }
+        void candidatesRemoved(const Cell*, CandidateMask mask) override { removed += mask.count(); }
+        void techniqueStarted(const Technique*) override { started++; }
+        void techniqueDone(const Technique*) override { finished++; }
+        void techniqueApplied(const Technique*) override { finished++; }
+        void cellAnalyzeStarted(const Technique*, Cell*) override { analyzeStarted++; }
+        void cellAnalyzeFinished(const Technique*, Cell*) override { analyzeFinished++; }
+    } recorder;
+
+    Field field;
+    QVERIFY(field.readFromPlainTextFile("../puzzle/naked-single.sdm", 0));
+    int unresolved = 0;
+    for (Coord coord = Coord::first(field.getN()); coord.isValid(); coord++)
+        if (!field.cell(coord)->isResolved())
+            unresolved++;
+
+    field.setCellObserver(&recorder);
+    Resolver resolver(field);
+    resolver.setTechniqueObserver(&recorder);
+    resolver.registerTechnique<NakedSingleTechnique>();
+    resolver.registerTechnique<HiddenSingleTechnique>();
+    resolver.process();
+    QVERIFY(field.isResolved());
+
+    QCOMPARE(recorder.valuesSet, unresolved);
+    QVERIFY(recorder.removed > 0);
+    QVERIFY(recorder.started > 0);
+    QCOMPARE(recorder.started, recorder.finished);
+    QVERIFY(recorder.analyzeStarted > 0);
+    QCOMPARE(recorder.analyzeStarted, recorder.analyzeFinished);
+
+    // detached observer gets nothing
+    field.setCellObserver(nullptr);
+    resolver.setTechniqueObserver(nullptr);
+    const int valuesSet = recorder.valuesSet;
+    const int started = recorder.started;
+    QVERIFY(field.readFromPlainTextFile("../puzzle/naked-single.sdm", 0));
+    resolver.process();
+    QCOMPARE(recorder.valuesSet, valuesSet);
+    QCOMPARE(recorder.started, started);
+}
+
+void CommonTest::Log_levels_test()
+{
+    bool ok = false;
+    QVERIFY(Log::levelFromName("Trace", &ok) == Log::Level::Trace && ok);
+    QVERIFY(Log::levelFromName("off", &ok) == Log::Level::Off && ok);
+    Log::levelFromName("verbose", &ok);
+    QVERIFY(!ok);
+
+    std::ostringstream sink;
+    const Log::Level savedLevel = Log::level();
+    Log::setStream(sink);
+
+    auto solve = [&sink](Log::Level level)
+    {
+        sink.str(std::string());
+        Log::setLevel(level);
+        Field field;
+        field.readFromPlainTextFile("../puzzle/naked-single.sdm", 0);
+        NakedSingleTechnique(field).perform();
+        return sink.str();
+    };
+    const std::string off = solve(Log::Level::Off);
+    const std::string info = solve(Log::Level::Info);
+    const std::string trace = solve(Log::Level::Trace);
+
+    Log::setLevel(savedLevel);
+    Log::setStream(std::clog);
+
+    QVERIFY(off.empty());
+    QVERIFY(info.find("Naked single") != std::string::npos);
+    QVERIFY(info.find("removed from") == std::string::npos);
+    if (Log::compiledIn(Log::Level::Trace))
+        QVERIFY(trace.find("removed from") != std::string::npos);
+}
+
+void CommonTest::CellSet_operations_test()
+{
+    Field field;
+    QVERIFY(field.readFromPlainTextFile("../puzzle/learningcurve.sdm", 0));
+    const quint8 n = field.getN();
+
+    // cells added out of order and twice still iterate once, in index order
+    CellSet a;
+    for (quint8 col = n; col >= 1; col--)
+        a.addCell(field.cell(Coord(2, col, n)));
+    a.addCell(field.cell(Coord(2, 5, n)));
+    QCOMPARE(a.count(), static_cast<int>(n));
+    for (int i = 1; i < a.count(); i++)
+        QVERIFY(a[i - 1]->coord() < a[i]->coord());
+
+    CellSet b;
+    for (quint8 row = 1; row <= n; row++)
+        b.addCell(field.cell(Coord(row, 4, n)));
+
+    auto indices = [](const CellSet& set)
+    {
+        QVector<quint16> ret;
+        for (Cell::CPtr pCell: set)
+            ret.append(pCell->coord().rawIndex());
+        return ret;
+    };
+    auto expected = [n](auto predicate)
+    {
+        QVector<quint16> ret;
+        for (Coord coord = Coord::first(n); coord.isValid(); coord++)
+            if (predicate(coord))
+                ret.append(coord.rawIndex());
+        return ret;
+    };
+
+    QCOMPARE(indices(a + b), expected([](const Coord& c) { return c.row() == 2 || c.col() == 4; }));
+    QCOMPARE(indices(a - b), expected([](const Coord& c) { return c.row() == 2 && c.col() != 4; }));
+    QCOMPARE(indices(a / b), expected([](const Coord& c) { return c.row() == 2 && c.col() == 4; }));
+    QCOMPARE((a + b).mask().count(), 2 * n - 1);
+
+    QVERIFY(a.hasCell(field.cell(Coord(2, 7, n))));
+    a.removeCell(field.cell(Coord(2, 7, n)));
+    QVERIFY(!a.hasCell(field.cell(Coord(2, 7, n))));
+    QCOMPARE(a.count(), n - 1);
+    QCOMPARE(a.mask().count(), n - 1);
+}
+
 void CommonTest::naked_single_tech_test()
 {
     TechTestValuesParams checks;
@@ -596,6 +968,1050 @@ void CommonTest::coloring_solve_test()
     QVERIFY(array9x9.isResolved());
 }
 
+void CommonTest::concurrent_solve_test()
+{
+    struct Job
+    {
+        QString filename;
+        int num;
+        bool groups;
+    };
+    const QVector<Job> jobs {{"../puzzle/learningcurve.sdm", 0, true},
+                             {"../puzzle/16x16.sdm", 1, true},
+                             {"../puzzle/25x25.sdm", 0, false}};
+
+    // reference results, one puzzle at a time
+    QVector<QVector<CellValue>> expected;
+    for (const Job& job: jobs)
+    {
+        Field field;
+        QVERIFY(field.readFromPlainTextFile(job.filename, job.num));
+        Resolver resolver(field);
+        registerAllTechniques(resolver, job.groups);
+        resolver.process();
+        QVERIFY(field.isValid());
+        expected.append(values(field));
+    }
+
+    // all sizes at once, each resolver on its own thread
+    std::list<Field> fields;
+    std::list<Resolver> resolvers;
+    for (const Job& job: jobs)
+    {
+        Field& field = fields.emplace_back();
+        QVERIFY(field.readFromPlainTextFile(job.filename, job.num));
+        registerAllTechniques(resolvers.emplace_back(field), job.groups);
+    }
+    for (Resolver& resolver: resolvers)
+        resolver.start();
+    for (Resolver& resolver: resolvers)
+        QVERIFY(resolver.wait());
+
+    auto field = fields.begin();
+    for (int i = 0; i < jobs.count(); i++, field++)
+    {
+        QVERIFY(field->isValid());
+        QCOMPARE(values(*field), expected[i]);
+    }
+    QVERIFY(fields.front().isResolved());
+    QVERIFY(std::next(fields.begin())->isResolved());
+}
+
+void CommonTest::solve_trace_replay_test()
+{
+    Field field;
+    QVERIFY(field.readFromPlainTextFile("../puzzle/learningcurve.sdm", 0));
+    Resolver resolver(field);
+    registerAllTechniques(resolver);
+
+    SolveTrace trace;
+    resolver.setTrace(&trace);
+    resolver.process();
+    QVERIFY(field.isResolved());
+    QVERIFY(!trace.records().isEmpty());
+    QVERIFY(field.getCellObserver() == nullptr);
+
+    const QString filename = "solve_trace_test.bin";
+    QVERIFY(trace.save(filename));
+    SolveTrace loaded;
+    QVERIFY(loaded.load(filename));
+    QFile saved(filename);
+    QVERIFY(saved.open(QFile::ReadOnly));
+    const QByteArray bytes = saved.readAll();
+    saved.close();
+    QCOMPARE(loaded.records().count(), trace.records().count());
+    QCOMPARE(loaded.techniqueNames(), trace.techniqueNames());
+
+    Field replayed;
+    std::ostringstream text;
+    QVERIFY(loaded.replay(replayed, text));
+    QVERIFY(replayed.isResolved());
+    QCOMPARE(values(replayed), values(field));
+    QVERIFY(text.str().find("Hidden Single") != std::string::npos);
+    QVERIFY(text.str().find("set into") != std::string::npos);
+
+    // damaged traces are refused and leave the trace empty
+    const qsizetype recordsAt = bytes.size() - trace.records().count() * 8;
+    QVERIFY(trace.techniqueFindings().isEmpty());   // recorded from Log::Level::Info up
+    const qsizetype lastCellAt = recordsAt - 4 - 4 - 5;
+    QVector<QByteArray> damaged {bytes.left(recordsAt + 5), bytes, bytes, bytes, bytes, bytes};
+    damaged[1].data()[6] = 10;                  // board size
+    damaged[2].data()[recordsAt] = 3;           // kind of the first record
+    for (int i = 1; i <= 4; i++)                // record count
+        damaged[3].data()[recordsAt - i] = char(0xFF);
+    damaged[4].data()[lastCellAt] = 10;         // start value of the last cell
+    damaged[5].data()[lastCellAt + 2] = 0x10;   // start candidates of the last cell
+    for (const QByteArray& content: damaged)
+    {
+        QFile file(filename);
+        QVERIFY(file.open(QFile::WriteOnly));
+        file.write(content);
+        file.close();
+        SolveTrace broken;
+        QVERIFY(!broken.load(filename));
+        QVERIFY(broken.records().isEmpty());
+        QCOMPARE(broken.getN(), quint8(0));
+    }
+
+    // records that load but contradict the board are refused by replay
+    qsizetype placedAt = -1;
+    qsizetype eliminatedAt = -1;
+    for (qsizetype k = 0; k < trace.records().count(); k++)
+    {
+        const SolveTrace::Kind kind = trace.records()[k].kind;
+        if (kind == SolveTrace::Kind::Placed && placedAt < 0)
+            placedAt = recordsAt + 8 * k;
+        if (kind == SolveTrace::Kind::Eliminated && eliminatedAt < 0)
+            eliminatedAt = recordsAt + 8 * k;
+    }
+    QVERIFY(placedAt >= 0 && eliminatedAt >= 0);
+    QVector<QByteArray> contradicting {bytes, bytes, bytes};
+    contradicting[0].data()[placedAt + 4] = 10;        // value above n
+    contradicting[1].data()[placedAt + 4] = 0;         // no value
+    for (int i = 4; i < 8; i++)                        // every candidate of the cell
+        contradicting[2].data()[eliminatedAt + i] = char(0xFF);
+    for (const QByteArray& content: contradicting)
+    {
+        QFile file(filename);
+        QVERIFY(file.open(QFile::WriteOnly));
+        file.write(content);
+        file.close();
+        SolveTrace broken;
+        QVERIFY(broken.load(filename));
+        Field brokenField;
+        std::ostringstream brokenText;
+        QVERIFY(!broken.replay(brokenField, brokenText));
+    }
+
+    // with technique explanations logged, the trace keeps them for replay
+    std::ostringstream sink;
+    const Log::Level savedLevel = Log::level();
+    Log::setStream(sink);
+    Log::setLevel(Log::Level::Trace);
+    Field explained;
+    QVERIFY(explained.readFromPlainTextFile("../puzzle/learningcurve.sdm", 0));
+    Resolver explaining(explained);
+    registerAllTechniques(explaining);
+    SolveTrace findingsTrace;
+    explaining.setTrace(&findingsTrace);
+    explaining.process();
+    Log::setLevel(savedLevel);
+    Log::setStream(std::clog);
+    QVERIFY(explained.isResolved());
+    QVERIFY(!findingsTrace.techniqueFindings().isEmpty());
+    if (Log::compiledIn(Log::Level::Info))
+        QVERIFY(sink.str().find("found in") != std::string::npos);
+    for (const QString& finding: findingsTrace.techniqueFindings())
+        QVERIFY(!finding.contains("removed from") && !finding.contains("set into"));
+
+    QVERIFY(findingsTrace.save(filename));
+    SolveTrace findingsLoaded;
+    QVERIFY(findingsLoaded.load(filename));
+    QCOMPARE(findingsLoaded.techniqueFindings(), findingsTrace.techniqueFindings());
+    Field findingsReplayed;
+    std::ostringstream findingsText;
+    QVERIFY(findingsLoaded.replay(findingsReplayed, findingsText));
+    QVERIFY(findingsText.str().find("found in") != std::string::npos);
+    QFile::remove(filename);
+}
+
+void CommonTest::solve_trace_search_test()
+{
+    // singles alone get stuck on this one, the search places the rest
+    Field field;
+    QVERIFY(field.readFromPlainTextFile("../puzzle/unsolveable.sdm", 0));
+    Resolver resolver(field);
+    resolver.registerTechnique<NakedSingleTechnique>();
+    resolver.registerTechnique<HiddenSingleTechnique>();
+    resolver.setSearchEnabled(true);
+
+    SolveTrace trace;
+    resolver.setTrace(&trace);
+    resolver.process();
+    QVERIFY(field.isResolved());
+    QVERIFY(resolver.stats().searched);
+
+    quint64 searchPlaced = 0;
+    for (const SolveTrace::Record& record: trace.records())
+    {
+        if (record.kind != SolveTrace::Kind::Placed)
+            continue;
+        if (record.technique == SolveTrace::SearchStep)
+            searchPlaced++;
+        else
+            QVERIFY(record.technique < trace.techniqueNames().count());
+    }
+    QCOMPARE(searchPlaced, quint64(resolver.stats().logicalUnresolved));
+
+    const QString filename = "solve_trace_search_test.bin";
+    QVERIFY(trace.save(filename));
+    SolveTrace loaded;
+    QVERIFY(loaded.load(filename));
+    QFile::remove(filename);
+
+    Field replayed;
+    std::ostringstream text;
+    QVERIFY(loaded.replay(replayed, text));
+    QVERIFY(replayed.isResolved());
+    QCOMPARE(values(replayed), values(field));
+    QVERIFY(text.str().find("(search)") != std::string::npos);
+
+    // 4x4 has no fixed-size engine, the search falls back to DLX
+    Field small;
+    QVERIFY(small.readFromPlainText(QString("1..............4")));
+    Resolver smallResolver(small);
+    smallResolver.setSearchEnabled(true);
+    SolveTrace smallTrace;
+    smallResolver.setTrace(&smallTrace);
+    smallResolver.process();
+    QVERIFY(small.isResolved());
+    QVERIFY(small.isValid());
+    QVERIFY(smallResolver.stats().searchNodes > 0);
+    QCOMPARE(smallTrace.records().count(), 1 + 14);
+    QCOMPARE(smallTrace.records().first().technique, SolveTrace::SearchStep);
+}
+
+void CommonTest::fast_singles_test()
+{
+    const QVector<std::pair<QString, int>> puzzles {{"../puzzle/learningcurve.sdm", 50},
+                                                    {"../puzzle/16x16.sdm", 3}};
+    for (const auto& [filename, count]: puzzles)
+    {
+        for (int idx = 0; idx < count; idx++)
+        {
+            Field dynamicField;
+            QVERIFY(dynamicField.readFromPlainTextFile(filename, idx));
+            Resolver dynamicResolver(dynamicField);
+            dynamicResolver.registerTechnique<NakedSingleTechnique>();
+            dynamicResolver.registerTechnique<HiddenSingleTechnique>();
+            dynamicResolver.process();
+
+            Field fastField;
+            QVERIFY(fastField.readFromPlainTextFile(filename, idx));
+            Resolver fastResolver(fastField);
+            fastResolver.registerTechnique<FastSinglesTechnique>();
+            fastResolver.process();
+
+            QVERIFY(fastField.isValid());
+            QCOMPARE(values(fastField), values(dynamicField));
+        }
+    }
+
+    // in place of the singles pair ahead of the other techniques, as the command line registers it
+    const QStringList files {"../puzzle/x-wing.sdm", "../puzzle/ywing.sdm", "../puzzle/coloring.sdm",
+                             "../puzzle/naked_group.sdm", "../puzzle/hidden_group.sdm"};
+    for (const QString& filename: files)
+    {
+        for (int idx = 0; idx < 6; idx++)
+        {
+            Field classicField;
+            QVERIFY(classicField.readFromPlainTextFile(filename, idx));
+            Resolver classicResolver(classicField);
+            registerAllTechniques(classicResolver);
+            classicResolver.process();
+
+            Field fastField;
+            QVERIFY(fastField.readFromPlainTextFile(filename, idx));
+            Resolver fastResolver(fastField);
+            registerAllTechniques(fastResolver, true, true);
+            fastResolver.process();
+
+            QCOMPARE(fastField.isResolved(), classicField.isResolved());
+            if (classicField.isResolved())
+                QCOMPARE(values(fastField), values(classicField));
+        }
+    }
+
+    bool called = false;
+    QVERIFY(!withBasicField(7, [&called](auto&) { called = true; return true; }));
+    QVERIFY(!called);
+}
+
+void CommonTest::search_fallback_test()
+{
+    for (int idx = 0; idx < 6; idx++)
+    {
+        Field logicalField;
+        QVERIFY(logicalField.readFromPlainTextFile("../puzzle/unsolveable.sdm", idx));
+        Resolver logicalResolver(logicalField);
+        logicalResolver.registerTechnique<NakedSingleTechnique>();
+        logicalResolver.registerTechnique<HiddenSingleTechnique>();
+        logicalResolver.process();
+        QVERIFY(!logicalField.isResolved());
+        QVERIFY(!logicalResolver.stats().searched);
+
+        Field field;
+        QVERIFY(field.readFromPlainTextFile("../puzzle/unsolveable.sdm", idx));
+        Resolver resolver(field);
+        resolver.registerTechnique<NakedSingleTechnique>();
+        resolver.registerTechnique<HiddenSingleTechnique>();
+        resolver.setSearchEnabled(true);
+        resolver.process();
+        QVERIFY(field.isResolved());
+        QVERIFY(resolver.stats().searched);
+        QVERIFY(resolver.stats().searchNodes > 0);
+        QCOMPARE(resolver.stats().logicalSteps, logicalResolver.stats().logicalSteps);
+        QVERIFY(resolver.stats().logicalUnresolved > 0);
+
+        for (Coord coord = Coord::first(field.getN()); coord.isValid(); coord++)
+            if (logicalField.cell(coord)->isResolved())
+                QCOMPARE(field.cell(coord)->value(), logicalField.cell(coord)->value());
+    }
+}
+
+void CommonTest::dlx_solver_test()
+{
+    const QVector<std::pair<QString, int>> puzzles {{"../puzzle/learningcurve.sdm", 50},
+                                                    {"../puzzle/16x16.sdm", 3},
+                                                    {"../puzzle/25x25.sdm", 1}};
+    for (const auto& [filename, count]: puzzles)
+    {
+        Field field;
+        QVERIFY(field.readFromPlainTextFile(filename, 0));
+        // one arena per size, reused for every puzzle of that size
+        DlxSolver dlx(field.geometry());
+        for (int idx = 0; idx < count; idx++)
+        {
+            QVERIFY(field.readFromPlainTextFile(filename, idx));
+            Field givens;
+            QVERIFY(givens.readFromPlainTextFile(filename, idx));
+
+            QCOMPARE(dlx.countSolutions(field), quint64(1));
+            QVERIFY(dlx.solve(field));
+            QVERIFY(dlx.nodesVisited() > 0);
+            QVERIFY(field.isResolved());
+            for (Coord coord = Coord::first(field.getN()); coord.isValid(); coord++)
+                if (givens.cell(coord)->isResolved())
+                    QCOMPARE(field.cell(coord)->value(), givens.cell(coord)->value());
+        }
+    }
+
+    Field empty;
+    empty.setN(9);
+    DlxSolver dlx(empty.geometry());
+    QCOMPARE(dlx.countSolutions(empty, 2), quint64(2));
+    QCOMPARE(dlx.countSolutions(empty, 0), quint64(0));
+
+    Field conflict;
+    conflict.setN(9);
+    conflict.cellAt(0)->setValue(5);
+    conflict.cellAt(1)->assignState(5, CandidateMask::fromRaw(1 << 4), true);
+    QCOMPARE(dlx.countSolutions(conflict), quint64(0));
+    QVERIFY(!dlx.solve(conflict));
+    // arena is restored after a rejected load
+    QCOMPARE(dlx.countSolutions(empty, 2), quint64(2));
+
+    Field other;
+    QVERIFY(other.readFromPlainTextFile("../puzzle/16x16.sdm", 0));
+    QVERIFY(!dlx.solve(other));
+}
+
+void CommonTest::bitboard_solver_test()
+{
+    Field field;
+    QVERIFY(field.readFromPlainTextFile("../puzzle/learningcurve.sdm", 0));
+    DlxSolver dlx(field.geometry());
+    for (int idx = 0; idx < 50; idx++)
+    {
+        Field expected;
+        QVERIFY(expected.readFromPlainTextFile("../puzzle/learningcurve.sdm", idx));
+        QString line;
+        for (quint16 cell = 0; cell < BitboardSolver::CellsCount; cell++)
+            line.append(QChar('0' + expected.cellAt(cell)->value()));
+        QVERIFY(dlx.solve(expected));
+
+        quint64 nodes = 0;
+        BitboardSolver parsed;
+        QVERIFY(parsed.parse(line));
+        QVERIFY(parsed.solve(nodes));
+        QVERIFY(parsed.isResolved());
+        QVERIFY(nodes > 0);
+
+        QVERIFY(field.readFromPlainTextFile("../puzzle/learningcurve.sdm", idx));
+        BitboardSolver loaded;
+        QVERIFY(loaded.load(field));
+        QVERIFY(loaded.solve(nodes));
+        QVERIFY(loaded.store(field) > 0);
+        QVERIFY(field.isResolved());
+
+        for (quint8 cell = 0; cell < BitboardSolver::CellsCount; cell++)
+        {
+            QCOMPARE(parsed.value(cell), expected.cellAt(cell)->value());
+            QCOMPARE(field.cellAt(cell)->value(), expected.cellAt(cell)->value());
+        }
+    }
+
+    BitboardSolver bitboard;
+    QVERIFY(!bitboard.parse(QString("11").append(QString(79, '0'))));
+    QVERIFY(!bitboard.parse(QString("123")));
+    QVERIFY(bitboard.parse(QString(81, '0')));
+    quint64 nodes = 0;
+    QVERIFY(bitboard.solve(nodes));
+    QVERIFY(bitboard.isResolved());
+
+    Field other;
+    QVERIFY(other.readFromPlainTextFile("../puzzle/16x16.sdm", 0));
+    QVERIFY(!bitboard.load(other));
+}
+
+void CommonTest::count_solutions_test()
+{
+    const QVector<std::pair<QString, int>> puzzles {{"../puzzle/learningcurve.sdm", 20},
+                                                    {"../puzzle/noponies.sdm", 20},
+                                                    {"../puzzle/16x16.sdm", 3}};
+    for (const auto& [filename, count]: puzzles)
+    {
+        for (int idx = 0; idx < count; idx++)
+        {
+            Field field;
+            QVERIFY(field.readFromPlainTextFile(filename, idx));
+            const SolutionCount result = field.countSolutions();
+            QCOMPARE(result.solutions, quint64(1));
+            QVERIFY(result.isUnique());
+            QVERIFY(result.nodes > 0);
+            QVERIFY(!field.isResolved());
+        }
+    }
+
+    Field empty;
+    empty.setN(9);
+    QCOMPARE(empty.countSolutions().solutions, quint64(2));
+    QVERIFY(!empty.countSolutions().isUnique());
+    QCOMPARE(empty.countSolutions(5).solutions, quint64(5));
+
+    const SolutionCount timedOut = empty.countSolutions(std::numeric_limits<quint64>::max(), QDeadlineTimer(10));
+    QVERIFY(timedOut.timedOut);
+    QVERIFY(!timedOut.isUnique());
+
+    Field conflict;
+    conflict.setN(9);
+    conflict.cellAt(0)->setValue(5);
+    conflict.cellAt(1)->assignState(5, CandidateMask::single(5), true);
+    QCOMPARE(conflict.countSolutions().solutions, quint64(0));
+}
+
+void CommonTest::incremental_scan_test()
+{
+    const QVector<std::pair<QString, int>> puzzles {{"../puzzle/learningcurve.sdm", 30},
+                                                    {"../puzzle/noponies.sdm", 10},
+                                                    {"../puzzle/16x16.sdm", 2}};
+    for (const auto& [filename, count]: puzzles)
+    {
+        for (int idx = 0; idx < count; idx++)
+        {
+            Field fullField;
+            QVERIFY(fullField.readFromPlainTextFile(filename, idx));
+            Resolver fullResolver(fullField);
+            registerAllTechniques(fullResolver);
+            fullResolver.setIncremental(false);
+            fullResolver.process();
+
+            Field field;
+            QVERIFY(field.readFromPlainTextFile(filename, idx));
+            Resolver resolver(field);
+            registerAllTechniques(resolver);
+            resolver.process();
+
+            QCOMPARE(values(field), values(fullField));
+            QCOMPARE(resolver.stats().logicalSteps, fullResolver.stats().logicalSteps);
+            QCOMPARE(fullResolver.stats().regionsSkipped, quint64(0));
+            QVERIFY(resolver.stats().regionsSkipped > 0);
+            QVERIFY(resolver.stats().regionScans < fullResolver.stats().regionScans);
+        }
+    }
+}
+
+void CommonTest::adaptive_schedule_test()
+{
+    Field fixedField;
+    Resolver fixedResolver(fixedField);
+    registerAllTechniques(fixedResolver);
+    QVERIFY(fixedResolver.schedule() == Resolver::Schedule::Fixed);
+
+    Field field;
+    Resolver resolver(field);
+    registerAllTechniques(resolver);
+    resolver.setSchedule(Resolver::Schedule::Adaptive);
+
+    for (int idx = 0; idx < 60; idx++)
+    {
+        QVERIFY(fixedField.readFromPlainTextFile("../puzzle/noponies.sdm", idx));
+        fixedResolver.process();
+        QVERIFY(field.readFromPlainTextFile("../puzzle/noponies.sdm", idx));
+        resolver.process();
+
+        QVERIFY(field.isValid());
+        QCOMPARE(field.isResolved(), fixedField.isResolved());
+        if (field.isResolved())
+            QCOMPARE(values(field), values(fixedField));
+    }
+
+    // singles still go first after every change
+    Technique* nakedSingle = resolver.technique("Naked Single");
+    QVERIFY(nakedSingle);
+    for (const Technique* tech: std::as_const(resolver.techniques))
+    {
+        QVERIFY(tech->runsCount() <= nakedSingle->runsCount());
+        QVERIFY(tech->runsCount() == 0 || tech->timeSpent() > 0);
+    }
+    QVERIFY(nakedSingle->changesMade() > 0);
+}
+
+void CommonTest::batch_elimination_test()
+{
+    int serialIterations = 0;
+    int batchIterations  = 0;
+    for (const char* file: {"../puzzle/noponies.sdm", "../tests/learningcurve.sdm"})
+        for (int idx = 0; idx < 30; idx++)
+        {
+            Field serialField;
+            QVERIFY(serialField.readFromPlainTextFile(file, idx));
+            Resolver serialResolver(serialField);
+            registerAllTechniques(serialResolver);
+            serialResolver.process();
+
+            Field field;
+            QVERIFY(field.readFromPlainTextFile(file, idx));
+            Resolver resolver(field);
+            registerAllTechniques(resolver);
+            resolver.setBatch(true);
+            QVERIFY(resolver.technique("Naked Group")->isBatch());
+            resolver.process();
+
+            QVERIFY(field.isValid());
+            QCOMPARE(field.isResolved(), serialField.isResolved());
+            if (field.isResolved())
+                QCOMPARE(values(field), values(serialField));
+            QVERIFY(resolver.stats().iterations == resolver.stats().logicalSteps + 1);
+            serialIterations += serialResolver.stats().iterations;
+            batchIterations += resolver.stats().iterations;
+        }
+    QVERIFY(batchIterations < serialIterations);
+}
+
+void CommonTest::parallel_techniques_test()
+{
+    struct Job
+    {
+        QString filename;
+        int num;
+        bool groups;
+    };
+    const QVector<Job> jobs {{"../tests/learningcurve.sdm", 0, true},
+                             {"../tests/learningcurve.sdm", 7, true},
+                             {"../puzzle/noponies.sdm", 3, true},
+                             {"../puzzle/coloring.sdm", 0, true},
+                             {"../puzzle/16x16.sdm", 1, true},
+                             {"../puzzle/25x25.sdm", 0, false}};
+
+    for (const Job& job: jobs)
+    {
+        // a parallel run must match a batch run on one thread step by step
+        Field batchField;
+        QVERIFY(batchField.readFromPlainTextFile(job.filename, job.num));
+        Resolver batchResolver(batchField);
+        registerAllTechniques(batchResolver, job.groups);
+        batchResolver.setBatch(true);
+        batchResolver.process();
+
+        for (int threads: {2, 4})
+        {
+            Field field;
+            QVERIFY(field.readFromPlainTextFile(job.filename, job.num));
+            Resolver resolver(field);
+            resolver.setThreadCount(threads);
+            registerAllTechniques(resolver, job.groups);
+            QCOMPARE(resolver.threadCount(), threads);
+            QVERIFY(resolver.technique("Hidden Single")->threadPool());
+            resolver.process();
+
+            QCOMPARE(field.isValid(), batchField.isValid());
+            QCOMPARE(field.isResolved(), batchField.isResolved());
+            QCOMPARE(values(field), values(batchField));
+            QCOMPARE(resolver.stats().iterations, batchResolver.stats().iterations);
+            QCOMPARE(resolver.stats().regionScans + resolver.stats().regionsSkipped,
+                     batchResolver.stats().regionScans + batchResolver.stats().regionsSkipped);
+        }
+    }
+
+    // the pool is kept but not used once back to one thread
+    Field field;
+    Resolver resolver(field);
+    registerAllTechniques(resolver);
+    resolver.setThreadCount(4);
+    resolver.setThreadCount(1);
+    QCOMPARE(resolver.threadCount(), 1);
+    QVERIFY(!resolver.technique("Hidden Single")->threadPool());
+}
+
+void CommonTest::cancellation_test()
+{
+    CancelToken token;
+    QVERIFY(!token.isCancelled());
+    token.cancel();
+    QVERIFY(token.isCancelled());
+    QVERIFY(token.checkNow());
+    token.clear();
+    QVERIFY(!token.checkNow());
+    token.setDeadline(QDeadlineTimer(0));
+    QVERIFY(token.checkNow());
+    QVERIFY(token.wasCancelled());
+    token.setDeadline(QDeadlineTimer(QDeadlineTimer::Forever));
+    QVERIFY(!token.wasCancelled());
+
+    {
+        Field field;
+        QVERIFY(field.readFromPlainTextFile("../puzzle/25x25.sdm", 0));
+        Resolver resolver(field);
+        registerAllTechniques(resolver);
+        resolver.setTimeLimit(200);
+        resolver.setSearchEnabled(true);
+
+        QElapsedTimer timer;
+        timer.start();
+        resolver.process();
+        QVERIFY(timer.elapsed() < 5000);
+        QVERIFY(resolver.stats().timedOut);
+        QVERIFY(!resolver.stats().searched);
+        QVERIFY(field.isValid());
+        QVERIFY(!field.isResolved());
+        // singles made progress before the groups got stuck
+        QVERIFY(resolver.stats().logicalSteps > 0);
+    }
+
+    {
+        Field field;
+        QVERIFY(field.readFromPlainTextFile("../puzzle/25x25.sdm", 0));
+        Resolver resolver(field);
+        registerAllTechniques(resolver);
+        resolver.start();
+        QThread::msleep(100);
+        QElapsedTimer timer;
+        timer.start();
+        resolver.stop();
+        QVERIFY(timer.elapsed() < 5000);
+        QVERIFY(!resolver.isRunning());
+        QVERIFY(resolver.stats().timedOut);
+        QVERIFY(field.isValid());
+
+        // a cancel() right after start() stops that run, even before its thread gets going
+        QVERIFY(field.readFromPlainTextFile("../puzzle/25x25.sdm", 0));
+        resolver.start();
+        resolver.cancel();
+        resolver.wait();
+        QVERIFY(resolver.stats().timedOut);
+        QCOMPARE(resolver.stats().logicalSteps, 0);
+    }
+
+    {
+        // a time limit is per run, a cancel() that comes after a run does not stop the next one
+        Field field;
+        QVERIFY(field.readFromPlainTextFile("../tests/learningcurve.sdm", 0));
+        Resolver resolver(field);
+        registerAllTechniques(resolver);
+        resolver.setTimeLimit(0);
+        resolver.process();
+        QVERIFY(resolver.stats().timedOut);
+        QCOMPARE(resolver.stats().logicalSteps, 0);
+        resolver.cancel();
+        resolver.setTimeLimit(60000);
+        resolver.process();
+        QVERIFY(!resolver.stats().timedOut);
+        QVERIFY(field.isResolved());
+    }
+}
+
+// first unresolved cell and its value in the solution, a guess that cannot fail
+static std::pair<Cell::Ptr, CellValue> safeGuess(Field& field)
+{
+    Field solved;
+    solved.setN(field.getN());
+    for (Coord coord = Coord::first(field.getN()); coord.isValid(); coord++)
+        if (field.cell(coord)->isResolved())
+            solved.cell(coord)->setValue(field.cell(coord)->value(), true);
+    DlxSolver dlx(solved.geometry());
+    if (!dlx.solve(solved))
+        return {nullptr, 0};
+    for (Coord coord = Coord::first(field.getN()); coord.isValid(); coord++)
+        if (!field.cell(coord)->isResolved())
+            return {field.cell(coord), solved.cell(coord)->value()};
+    return {nullptr, 0};
+}
+
+// values, candidates and candidate planes of every cell, for exact comparisons
+static QVector<qint64> boardState(const Field& field)
+{
+    QVector<qint64> ret;
+    const CandidatePlanes& planes = field.candidatePlanes();
+    for (Coord coord = Coord::first(field.getN()); coord.isValid(); coord++)
+    {
+        Cell::CPtr pCell = field.cell(coord);
+        ret.append(pCell->value());
+        ret.append(pCell->isInitialValue());
+        ret.append(planes.solvedCells().test(coord.rawIndex()));
+        for (CellValue v = 1; v <= field.getN(); v++)
+        {
+            ret.append(pCell->hasCandidate(v));
+            ret.append(planes.digit(v).test(coord.rawIndex()));
+        }
+    }
+    for (quint8 house = 0; house < 3 * field.getN(); house++)
+        for (CellValue v = 1; v <= field.getN(); v++)
+            ret.append(static_cast<qint64>(planes.housePositions(house, v)));
+    return ret;
+}
+
+void CommonTest::snapshot_restore_test()
+{
+    Field reference;
+    QVERIFY(reference.readFromPlainTextFile("../puzzle/noponies.sdm", 0));
+    Resolver referenceResolver(reference);
+    registerAllTechniques(referenceResolver);
+    referenceResolver.process();
+
+    Field field;
+    QVERIFY(field.readFromPlainTextFile("../puzzle/noponies.sdm", 0));
+    NakedSingleTechnique nakedSingle(field);
+    IntersectionsTechnique intersections(field);
+    for (int step = 0; step < 3 && (nakedSingle.perform() || intersections.perform()); step++);
+
+    Field::Snapshot snapshot;
+    field.saveState(snapshot);
+    const QVector<qint64> saved = boardState(field);
+    const quint64 changesBefore = field.candidatePlanes().lastChange();
+
+    Resolver resolver(field);
+    registerAllTechniques(resolver);
+    resolver.process();
+    QVERIFY(boardState(field) != saved);
+
+    QVERIFY(field.restoreState(snapshot));
+    QCOMPARE(boardState(field), saved);
+    QVERIFY(field.isValid());
+    // regions count as changed, so techniques scan them again
+    QVERIFY(field.candidatePlanes().lastChange() > changesBefore);
+
+    resolver.process();
+    QCOMPARE(boardState(field), boardState(reference));
+
+    // a snapshot is reusable and only fits boards of its own size
+    QVERIFY(field.restoreState(snapshot));
+    QCOMPARE(boardState(field), saved);
+    Field other;
+    QVERIFY(other.readFromPlainTextFile("../puzzle/16x16.sdm", 0));
+    QVERIFY(!other.restoreState(snapshot));
+}
+
+void CommonTest::trail_undo_test()
+{
+    Field field;
+    QVERIFY(field.readFromPlainTextFile("../puzzle/noponies.sdm", 0));
+    CellTrail trail;
+    field.setTrail(&trail);
+
+    const QVector<qint64> initial = boardState(field);
+    const CellTrail::Mark outer = trail.mark();
+    QCOMPARE(outer, qsizetype(0));
+
+    NakedSingleTechnique nakedSingle(field);
+    IntersectionsTechnique intersections(field);
+    for (int step = 0; step < 2 && (nakedSingle.perform() || intersections.perform()); step++);
+    QVERIFY(trail.size() > 0);
+    const QVector<qint64> middle = boardState(field);
+    const CellTrail::Mark inner = trail.mark();
+
+    const auto [pGuess, guess] = safeGuess(field);
+    QVERIFY(pGuess);
+    pGuess->setValue(guess);
+    while (nakedSingle.perform() || intersections.perform());
+    QVERIFY(trail.size() > inner);
+    QVERIFY(boardState(field) != middle);
+
+    trail.undo(field, inner);
+    QCOMPARE(trail.size(), inner);
+    QCOMPARE(boardState(field), middle);
+
+    trail.undo(field, outer);
+    QCOMPARE(trail.size(), qsizetype(0));
+    QCOMPARE(boardState(field), initial);
+
+    // undo itself is not recorded, a detached field records nothing
+    field.setTrail(nullptr);
+    pGuess->setValue(guess);
+    QCOMPARE(trail.size(), qsizetype(0));
+}
+
+void CommonTest::field_reuse_test()
+{
+    struct ResetCounter : CellObserver
+    {
+        int resets {0};
+        void cellReset(const Cell*) override { resets++; }
+    };
+
+    Field field;
+    QVERIFY(field.readFromPlainTextFile("../puzzle/16x16.sdm", 0));
+    QVERIFY(field.readFromPlainTextFile("../puzzle/learningcurve.sdm", 0));
+    Cell::CPtr firstCell = field.cellAt(0);
+    ResetCounter counter;
+    field.setCellObserver(&counter);
+
+    Resolver resolver(field);
+    resolver.registerTechnique<NakedSingleTechnique>();
+    resolver.registerTechnique<HiddenSingleTechnique>();
+    resolver.registerTechnique<IntersectionsTechnique>();
+    for (int idx = 1; idx <= 5; idx++)
+    {
+        counter.resets = 0;
+        QVERIFY(field.readFromPlainTextFile("../puzzle/learningcurve.sdm", idx));
+        // same size: cells are kept and only their state is reset
+        QCOMPARE(field.cellAt(0), firstCell);
+        QCOMPARE(counter.resets, 81);
+
+        Field fresh;
+        QVERIFY(fresh.readFromPlainTextFile("../puzzle/learningcurve.sdm", idx));
+        QCOMPARE(boardState(field), boardState(fresh));
+
+        Resolver freshResolver(fresh);
+        freshResolver.registerTechnique<NakedSingleTechnique>();
+        freshResolver.registerTechnique<HiddenSingleTechnique>();
+        freshResolver.registerTechnique<IntersectionsTechnique>();
+        resolver.process();
+        freshResolver.process();
+        QCOMPARE(boardState(field), boardState(fresh));
+        QCOMPARE(resolver.stats().logicalSteps, freshResolver.stats().logicalSteps);
+    }
+    field.setCellObserver(nullptr);
+
+    QVERIFY(field.readFromPlainTextFile("../puzzle/16x16.sdm", 0));
+    QCOMPARE(field.getN(), quint8(16));
+    QVERIFY(field.isValid());
+    QVERIFY(!field.readFromPlainText(QString("1234567")));
+    // square lengths without a board size: 6x6, 2x2 and 1x1 have no square boxes
+    for (int length: {36, 4, 1})
+        QVERIFY(!field.readFromPlainText(QString(length, QChar('.'))));
+    // 'A' stands for 10, which no 9x9 cell can hold
+    QVERIFY(!field.readFromPlainText(QString("A") + QString(80, QChar('.'))));
+    QCOMPARE(field.getN(), quint8(16));
+    QVERIFY(field.isValid());
+}
+
+void CommonTest::puzzle_corpus_test()
+{
+    QFile source("../puzzle/learningcurve.sdm");
+    QVERIFY(source.open(QFile::ReadOnly));
+    QTextStream stream(&source);
+    QStringList puzzles;
+    while (puzzles.count() < 20 && !stream.atEnd())
+        puzzles.append(stream.readLine().simplified());
+
+    // comments, blank lines, CRLF and stray spaces are not part of puzzles
+    auto writeCorpus = [](const QString& filename, const QStringList& lines)
+    {
+        QFile file(filename);
+        if (!file.open(QFile::WriteOnly))
+            return false;
+        std::string text = "# test corpus\r\n\r\n";
+        for (int k = 0; k < lines.count(); k++)
+        {
+            text += (k % 3 ? "" : "  ") + lines[k].toStdString() + (k % 2 ? "\n" : " \r\n");
+            if (k == 5)
+                text += "#" + lines[k].toStdString() + "\n\n";
+        }
+        return file.write(text.data(), static_cast<qint64>(text.size())) == static_cast<qint64>(text.size());
+    };
+
+    const QString filename = "puzzle_corpus_test.sdm";
+    const QString indexName = PuzzleCorpus::indexFileName(filename);
+    QFile::remove(indexName);
+    QVERIFY(writeCorpus(filename, puzzles));
+
+    PuzzleCorpus corpus;
+    QVERIFY(corpus.open(filename));
+    QVERIFY(!corpus.indexFromSidecar());
+    QCOMPARE(corpus.count(), puzzles.count());
+    for (int k = 0; k < puzzles.count(); k++)
+    {
+        QCOMPARE(corpus.puzzle(k).toString(), puzzles[k]);
+        Field fromCorpus;
+        QVERIFY(fromCorpus.readFromPlainText(corpus.puzzle(k)));
+        Field fromFile;
+        QVERIFY(fromFile.readFromPlainTextFile("../puzzle/learningcurve.sdm", k));
+        QCOMPARE(boardState(fromCorpus), boardState(fromFile));
+    }
+    QVERIFY(corpus.puzzle(puzzles.count()).isEmpty());
+    QVERIFY(corpus.puzzle(-1).isEmpty());
+
+    // the second open takes the sidecar, a changed file is scanned again
+    QVERIFY(corpus.open(filename));
+    QVERIFY(corpus.indexFromSidecar());
+    QCOMPARE(corpus.count(), puzzles.count());
+    QCOMPARE(corpus.puzzle(7).toString(), puzzles[7]);
+    corpus.close();
+    QVERIFY(!corpus.isOpen());
+
+    puzzles.resize(12);
+    QVERIFY(writeCorpus(filename, puzzles));
+    QVERIFY(corpus.open(filename));
+    QVERIFY(!corpus.indexFromSidecar());
+    QCOMPARE(corpus.count(), qsizetype(12));
+    QCOMPARE(corpus.puzzle(11).toString(), puzzles[11]);
+
+    QFile::remove(indexName);
+    QVERIFY(corpus.open(filename, false));
+    QVERIFY(!corpus.indexFromSidecar());
+    QVERIFY(!QFile::exists(indexName));
+    QCOMPARE(corpus.count(), qsizetype(12));
+    corpus.close();
+
+    QFile::remove(filename);
+    QVERIFY(!corpus.open(filename));
+}
+
+void CommonTest::packed_corpus_test()
+{
+    QCOMPARE(PackedCorpus::bitsPerCell(9), quint8(4));
+    QCOMPARE(PackedCorpus::bitsPerCell(16), quint8(5));
+    QCOMPARE(PackedCorpus::bitsPerCell(25), quint8(5));
+    QCOMPARE(PackedCorpus::cellsSize(9), qsizetype(41));
+    QCOMPARE(PackedCorpus::cellsSize(25), qsizetype(391));
+
+    const QString filename = "packed_corpus_test.sdpk";
+    const quint8 everything = PackedCorpus::Solutions | PackedCorpus::Ratings;
+    QCOMPARE(PackedCorpusWriter::convert("../puzzle/noponies.sdm", filename, everything), qint64(250));
+    QCOMPARE(QFileInfo(filename).size(), PackedCorpus::HeaderSize + 250 * (41 + 41 + 4));
+
+    PackedCorpus corpus;
+    QVERIFY(corpus.open(filename));
+    QCOMPARE(corpus.getN(), quint8(9));
+    QCOMPARE(corpus.count(), qsizetype(250));
+    QVERIFY(corpus.hasSolutions());
+    QVERIFY(corpus.hasRatings());
+    for (int k: {0, 1, 17, 249})
+    {
+        Field packed;
+        QVERIFY(corpus.loadPuzzle(k, packed));
+        Field plain;
+        QVERIFY(plain.readFromPlainTextFile("../puzzle/noponies.sdm", k));
+        QCOMPARE(boardState(packed), boardState(plain));
+
+        Field solution;
+        QVERIFY(corpus.loadSolution(k, solution));
+        QVERIFY(solution.isResolved());
+        QVERIFY(solution.isValid());
+        for (quint16 idx = 0; idx < 81; idx++)
+            if (plain.cellAt(idx)->isResolved())
+                QCOMPARE(solution.cellAt(idx)->value(), plain.cellAt(idx)->value());
+        QVERIFY(corpus.rating(k) > 0);
+    }
+    Field outOfRange;
+    QVERIFY(!corpus.loadPuzzle(250, outOfRange));
+
+    // givens only, 5 bits per cell
+    QCOMPARE(PackedCorpusWriter::convert("../puzzle/25x25.sdm", filename, PackedCorpus::Givens), qint64(1));
+    QVERIFY(corpus.open(filename));
+    QCOMPARE(QFileInfo(filename).size(), PackedCorpus::HeaderSize + 391);
+    QVERIFY(!corpus.hasSolutions());
+    QCOMPARE(corpus.rating(0), quint32(0));
+    {
+        Field packed;
+        QVERIFY(corpus.loadPuzzle(0, packed));
+        Field plain;
+        QVERIFY(plain.readFromPlainTextFile("../puzzle/25x25.sdm", 0));
+        QCOMPARE(boardState(packed), boardState(plain));
+        QVERIFY(!corpus.loadSolution(0, packed));
+    }
+
+    QCOMPARE(PackedCorpusWriter::convert("../puzzle/input.fsdm", filename, everything), qint64(1));
+    QVERIFY(corpus.open(filename));
+    {
+        Field packed;
+        QVERIFY(corpus.loadPuzzle(0, packed));
+        Field formatted;
+        QVERIFY(formatted.readFromFormattedTextFile("../puzzle/input.fsdm"));
+        QCOMPARE(boardState(packed), boardState(formatted));
+    }
+    corpus.close();
+
+    // store and load keep only the givens
+    Field field;
+    QVERIFY(field.readFromPlainTextFile("../puzzle/16x16.sdm", 0));
+    const QVector<qint64> givens = boardState(field);
+    NakedSingleTechnique nakedSingle(field);
+    nakedSingle.perform();
+    QVector<uchar> record(PackedCorpus::cellsSize(16), 0);
+    field.storePacked(record.data(), true);
+    QVERIFY(field.readFromPacked(record.constData(), 16));
+    QCOMPARE(boardState(field), givens);
+
+    // a plain text file or a truncated corpus is refused
+    QVERIFY(!corpus.open("../puzzle/noponies.sdm"));
+    QCOMPARE(PackedCorpusWriter::convert("../puzzle/noponies.sdm", filename, PackedCorpus::Givens), qint64(250));
+    {
+        QFile file(filename);
+        QVERIFY(file.open(QFile::ReadOnly));
+        const QByteArray bytes = file.readAll();
+        file.close();
+        QVERIFY(file.open(QFile::WriteOnly));
+        file.write(bytes.constData(), PackedCorpus::HeaderSize + 100 * 41);
+    }
+    QVERIFY(!corpus.open(filename));
+    QVERIFY(!corpus.isOpen());
+    QFile::remove(filename);
+
+    // a puzzle without solution fails the conversion and leaves no file
+    const QString broken = "packed_corpus_test.sdm";
+    {
+        QFile file(broken);
+        QVERIFY(file.open(QFile::WriteOnly));
+        const std::string text = "11" + std::string(79, '0') + "\n";
+        file.write(text.data(), static_cast<qint64>(text.size()));
+    }
+    QCOMPARE(PackedCorpusWriter::convert(broken, filename, everything), qint64(-1));
+    QVERIFY(!QFile::exists(filename));
+
+    // givens that leave a cell without candidates fail as well, after the first puzzle was written
+    {
+        QFile file(broken);
+        QVERIFY(file.open(QFile::WriteOnly));
+        const std::string text = "1" + std::string(80, '0') + "\n" + "123456780" + "000000009" + std::string(63, '0') + "\n";
+        file.write(text.data(), static_cast<qint64>(text.size()));
+    }
+    QCOMPARE(PackedCorpusWriter::convert(broken, filename, PackedCorpus::Givens), qint64(-1));
+    QVERIFY(!QFile::exists(filename));
+    QFile::remove(broken);
+
+    // a conversion that fails before writing anything keeps an existing target
+    {
+        QFile file(filename);
+        QVERIFY(file.open(QFile::WriteOnly));
+        file.write("keep", 4);
+    }
+    QCOMPARE(PackedCorpusWriter::convert("packed_corpus_missing.sdm", filename, PackedCorpus::Givens), qint64(-1));
+    QCOMPARE(QFileInfo(filename).size(), qint64(4));
+    QFile::remove(filename);
+}
+
 void CommonTest::benchmark9x9()
 {
     Field array9x9;
@@ -605,16 +2021,7 @@ void CommonTest::benchmark9x9()
     bool isValid = false;
 
     Resolver resolver9x9(array9x9, nullptr);
-    resolver9x9.registerTechnique<NakedSingleTechnique>();
-    resolver9x9.registerTechnique<HiddenSingleTechnique>();
-    resolver9x9.registerTechnique<NakedGroupTechnique>();
-    resolver9x9.registerTechnique<HiddenGroupTechnique>();
-    resolver9x9.registerTechnique<IntersectionsTechnique>();
-    resolver9x9.registerTechnique<BiLocationColoringTechnique>();
-    resolver9x9.registerTechnique<XWingTechnique>();
-    resolver9x9.registerTechnique<YWingTechnique>();
-    resolver9x9.registerTechnique<XYZWingTechnique>();
-    resolver9x9.registerTechnique<UniqueRectangle>();
+    registerAllTechniques(resolver9x9);
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
     QRandomGenerator rng(25121981);
@@ -639,6 +2046,539 @@ void CommonTest::benchmark9x9()
     QVERIFY(isResolved);
 }
 
+void CommonTest::benchmark25x25()
+{
+    Field array25x25;
+    QVERIFY(array25x25.readFromPlainTextFile("../puzzle/25x25.sdm", 0));
+
+    // group techniques are left out: on 25x25 they do not finish in reasonable time
+    Resolver resolver25x25(array25x25, nullptr);
+    resolver25x25.registerTechnique<NakedSingleTechnique>();
+    resolver25x25.registerTechnique<HiddenSingleTechnique>();
+    resolver25x25.registerTechnique<IntersectionsTechnique>();
+    resolver25x25.registerTechnique<BiLocationColoringTechnique>();
+    resolver25x25.registerTechnique<XWingTechnique>();
+    resolver25x25.registerTechnique<YWingTechnique>();
+    resolver25x25.registerTechnique<XYZWingTechnique>();
+    resolver25x25.registerTechnique<UniqueRectangle>();
+
+    QBENCHMARK {
+        QVERIFY(array25x25.readFromPlainTextFile("../puzzle/25x25.sdm", 0));
+        resolver25x25.process();
+    }
+
+    QVERIFY(array25x25.isValid());
+}
+
+void CommonTest::benchmarkParallel16x16_data()
+{
+    QTest::addColumn<int>("threads");
+    QTest::newRow("1") << 1;
+    QTest::newRow("2") << 2;
+    QTest::newRow("4") << 4;
+    QTest::newRow("8") << 8;
+}
+
+void CommonTest::benchmarkParallel16x16()
+{
+    QFETCH(int, threads);
+
+    Field array16x16;
+    Resolver resolver16x16(array16x16, nullptr);
+    resolver16x16.registerTechnique<NakedSingleTechnique>();
+    resolver16x16.registerTechnique<HiddenSingleTechnique>();
+    resolver16x16.registerTechnique<NakedGroupTechnique>();
+    resolver16x16.registerTechnique<HiddenGroupTechnique>();
+    resolver16x16.registerTechnique<IntersectionsTechnique>();
+    resolver16x16.registerTechnique<BiLocationColoringTechnique>();
+    resolver16x16.registerTechnique<XWingTechnique>();
+    resolver16x16.registerTechnique<YWingTechnique>();
+    resolver16x16.registerTechnique<XYZWingTechnique>();
+    resolver16x16.registerTechnique<UniqueRectangle>();
+    // one thread runs the same batches, so rows differ only by the thread count
+    resolver16x16.setBatch(true);
+    resolver16x16.setThreadCount(threads);
+
+    QBENCHMARK {
+        QVERIFY(array16x16.readFromPlainTextFile("../puzzle/16x16.sdm", 1));
+        resolver16x16.process();
+    }
+
+    QVERIFY(array16x16.isValid());
+    QVERIFY(array16x16.isResolved());
+}
+
+void CommonTest::benchmarkParallel25x25_data()
+{
+    benchmarkParallel16x16_data();
+}
+
+void CommonTest::benchmarkParallel25x25()
+{
+    QFETCH(int, threads);
+
+    Field array25x25;
+    // group techniques are left out: on 25x25 they do not finish in reasonable time
+    Resolver resolver25x25(array25x25, nullptr);
+    resolver25x25.registerTechnique<NakedSingleTechnique>();
+    resolver25x25.registerTechnique<HiddenSingleTechnique>();
+    resolver25x25.registerTechnique<IntersectionsTechnique>();
+    resolver25x25.registerTechnique<BiLocationColoringTechnique>();
+    resolver25x25.registerTechnique<XWingTechnique>();
+    resolver25x25.registerTechnique<YWingTechnique>();
+    resolver25x25.registerTechnique<XYZWingTechnique>();
+    resolver25x25.registerTechnique<UniqueRectangle>();
+    resolver25x25.setBatch(true);
+    resolver25x25.setThreadCount(threads);
+
+    QBENCHMARK {
+        QVERIFY(array25x25.readFromPlainTextFile("../puzzle/25x25.sdm", 0));
+        resolver25x25.process();
+    }
+
+    QVERIFY(array25x25.isValid());
+}
+
+void CommonTest::benchmarkDlx16x16()
+{
+    Field array16x16;
+    QVERIFY(array16x16.readFromPlainTextFile("../puzzle/16x16.sdm", 1));
+    DlxSolver dlx(array16x16.geometry());
+
+    QBENCHMARK {
+        QVERIFY(array16x16.readFromPlainTextFile("../puzzle/16x16.sdm", 1));
+        QVERIFY(dlx.solve(array16x16));
+    }
+
+    QVERIFY(array16x16.isResolved());
+}
+
+void CommonTest::benchmarkDlx25x25()
+{
+    Field array25x25;
+    QVERIFY(array25x25.readFromPlainTextFile("../puzzle/25x25.sdm", 0));
+    DlxSolver dlx(array25x25.geometry());
+
+    QBENCHMARK {
+        QVERIFY(array25x25.readFromPlainTextFile("../puzzle/25x25.sdm", 0));
+        QVERIFY(dlx.solve(array25x25));
+    }
+
+    QVERIFY(array25x25.isResolved());
+}
+
+void CommonTest::benchmarkLearningCurve()
+{
+    Field array9x9;
+    QVERIFY(array9x9.readFromPlainTextFile("../puzzle/learningcurve.sdm", 0));
+
+    Resolver resolver9x9(array9x9, nullptr);
+    registerAllTechniques(resolver9x9);
+
+    int resolved = 0;
+    QBENCHMARK {
+        resolved = 0;
+        for (int idx = 0; idx < 100; idx++)
+        {
+            QVERIFY(array9x9.readFromPlainTextFile("../puzzle/learningcurve.sdm", idx));
+            resolver9x9.process();
+            if (array9x9.isResolved())
+                resolved++;
+        }
+    }
+    QCOMPARE(resolved, 100);
+}
+
+void CommonTest::benchmarkLearningCurveAdaptive()
+{
+    Field array9x9;
+    QVERIFY(array9x9.readFromPlainTextFile("../puzzle/learningcurve.sdm", 0));
+
+    Resolver resolver9x9(array9x9, nullptr);
+    registerAllTechniques(resolver9x9);
+    resolver9x9.setSchedule(Resolver::Schedule::Adaptive);
+
+    int resolved = 0;
+    QBENCHMARK {
+        resolved = 0;
+        for (int idx = 0; idx < 100; idx++)
+        {
+            QVERIFY(array9x9.readFromPlainTextFile("../puzzle/learningcurve.sdm", idx));
+            resolver9x9.process();
+            if (array9x9.isResolved())
+                resolved++;
+        }
+    }
+    QCOMPARE(resolved, 100);
+}
+
+void CommonTest::benchmarkCancelPolling_data()
+{
+    QTest::addColumn<bool>("polled");
+    QTest::newRow("token") << true;
+    QTest::newRow("bare loop") << false;
+}
+
+void CommonTest::benchmarkCancelPolling()
+{
+    QFETCH(bool, polled);
+
+    // isCancelled() in a hot loop against the same loop without it
+    CancelToken token;
+    token.setDeadline(QDeadlineTimer(60000));
+    quint64 sum = 0;
+    QBENCHMARK {
+        for (quint32 i = 0; i < 1000000; i++)
+        {
+            if (polled && token.isCancelled())
+                break;
+            sum += i ^ (sum >> 3);
+        }
+    }
+    QVERIFY(sum > 0);
+}
+
+void CommonTest::benchmarkSnapshotRestore_data()
+{
+    QTest::addColumn<QString>("filename");
+    QTest::newRow("9x9") << "../puzzle/learningcurve.sdm";
+    QTest::newRow("25x25") << "../puzzle/25x25.sdm";
+}
+
+void CommonTest::benchmarkSnapshotRestore()
+{
+    QFETCH(QString, filename);
+
+    Field field;
+    QVERIFY(field.readFromPlainTextFile(filename, 0));
+    Field::Snapshot snapshot;
+    field.saveState(snapshot);
+    QBENCHMARK {
+        field.saveState(snapshot);
+        field.restoreState(snapshot);
+    }
+    QVERIFY(field.isValid());
+}
+
+void CommonTest::benchmarkTrailUndo()
+{
+    // a typical search step: guess, propagate singles, backtrack
+    Field field;
+    QVERIFY(field.readFromPlainTextFile("../puzzle/learningcurve.sdm", 0));
+    CellTrail trail;
+    field.setTrail(&trail);
+    NakedSingleTechnique nakedSingle(field);
+    const auto [pGuess, guess] = safeGuess(field);
+    QVERIFY(pGuess);
+
+    QBENCHMARK {
+        const CellTrail::Mark mark = trail.mark();
+        pGuess->setValue(guess);
+        nakedSingle.perform();
+        trail.undo(field, mark);
+    }
+    QCOMPARE(trail.size(), qsizetype(0));
+}
+
+void CommonTest::benchmarkLoadPuzzle_data()
+{
+    QTest::addColumn<bool>("reuse");
+    QTest::newRow("same field") << true;
+    QTest::newRow("new field") << false;
+}
+
+void CommonTest::benchmarkLoadPuzzle()
+{
+    QFETCH(bool, reuse);
+
+    // givens only, the file is read beforehand
+    QFile inputFile("../puzzle/learningcurve.sdm");
+    QVERIFY(inputFile.open(QFile::ReadOnly));
+    QTextStream stream(&inputFile);
+    QStringList lines;
+    while (!stream.atEnd())
+    {
+        const QString line = stream.readLine().simplified();
+        if (!line.isEmpty() && !line.startsWith('#'))
+            lines.append(line);
+    }
+
+    Field field;
+    int loaded = 0;
+    QBENCHMARK {
+        loaded = 0;
+        for (const QString& line: std::as_const(lines))
+        {
+            if (reuse)
+            {
+                if (field.readFromPlainText(line))
+                    loaded++;
+            }
+            else
+            {
+                Field fresh;
+                if (fresh.readFromPlainText(line))
+                    loaded++;
+            }
+        }
+    }
+    QCOMPARE(loaded, lines.count());
+}
+
+void CommonTest::benchmarkCorpusAccess_data()
+{
+    QTest::addColumn<bool>("indexed");
+    QTest::newRow("corpus") << true;
+    QTest::newRow("plain text file") << false;
+}
+
+void CommonTest::benchmarkCorpusAccess()
+{
+    QFETCH(bool, indexed);
+
+    // 100 puzzles spread over the file, loaded by number
+    PuzzleCorpus corpus;
+    QVERIFY(corpus.open("../puzzle/learningcurve.sdm", false));
+    const qsizetype step = corpus.count() / 100;
+
+    Field field;
+    int loaded = 0;
+    QBENCHMARK {
+        loaded = 0;
+        for (qsizetype k = 0; k < 100 * step; k += step)
+        {
+            const bool ok = indexed ? field.readFromPlainText(corpus.puzzle(k))
+                                    : field.readFromPlainTextFile("../puzzle/learningcurve.sdm", static_cast<int>(k));
+            if (ok)
+                loaded++;
+        }
+    }
+    QCOMPARE(loaded, 100);
+}
+
+void CommonTest::benchmarkPackedCorpus_data()
+{
+    QTest::addColumn<bool>("packed");
+    QTest::newRow("packed") << true;
+    QTest::newRow("plain text corpus") << false;
+}
+
+void CommonTest::benchmarkPackedCorpus()
+{
+    QFETCH(bool, packed);
+
+    // every puzzle of the file, both sources memory-mapped
+    const QString filename = "benchmark_packed.sdpk";
+    QVERIFY(PackedCorpusWriter::convert("../puzzle/learningcurve.sdm", filename, PackedCorpus::Givens) > 0);
+    PackedCorpus packedCorpus;
+    QVERIFY(packedCorpus.open(filename));
+    PuzzleCorpus textCorpus;
+    QVERIFY(textCorpus.open("../puzzle/learningcurve.sdm", false));
+    QCOMPARE(packedCorpus.count(), textCorpus.count());
+
+    Field field;
+    qsizetype loaded = 0;
+    QBENCHMARK {
+        loaded = 0;
+        for (qsizetype k = 0; k < packedCorpus.count(); k++)
+        {
+            const bool ok = packed ? packedCorpus.loadPuzzle(k, field) : field.readFromPlainText(textCorpus.puzzle(k));
+            if (ok)
+                loaded++;
+        }
+    }
+    QCOMPARE(loaded, packedCorpus.count());
+    packedCorpus.close();
+    QFile::remove(filename);
+}
+
+void CommonTest::benchmarkLogLevels_data()
+{
+    QTest::addColumn<int>("level");
+    QTest::newRow("off") << static_cast<int>(Log::Level::Off);
+    QTest::newRow("summary") << static_cast<int>(Log::Level::Summary);
+    QTest::newRow("trace") << static_cast<int>(Log::Level::Trace);
+}
+
+void CommonTest::benchmarkLogLevels()
+{
+    QFETCH(int, level);
+
+    // formatting is measured, console output is not
+    std::ostringstream sink;
+    const Log::Level savedLevel = Log::level();
+    Log::setStream(sink);
+    Log::setLevel(static_cast<Log::Level>(level));
+
+    Field array9x9;
+    Resolver resolver9x9(array9x9, nullptr);
+    registerAllTechniques(resolver9x9);
+
+    int resolved = 0;
+    QBENCHMARK {
+        resolved = 0;
+        for (int idx = 0; idx < 2000; idx++)
+        {
+            QVERIFY(array9x9.readFromPlainTextFile("../puzzle/learningcurve.sdm", idx));
+            resolver9x9.process();
+            if (array9x9.isResolved())
+                resolved++;
+            sink.str(std::string());
+        }
+    }
+
+    Log::setLevel(savedLevel);
+    Log::setStream(std::clog);
+    QCOMPARE(resolved, 2000);
+}
+
+void CommonTest::benchmarkCandidateMask()
+{
+    Field array9x9;
+    QVERIFY(array9x9.readFromPlainTextFile("../puzzle/learningcurve.sdm", 1));
+
+    int common = 0;
+    QBENCHMARK {
+        common = 0;
+        for (Coord a = Coord::first(array9x9.getN()); a.isValid(); a++)
+            for (Coord b = Coord::first(array9x9.getN()); b.isValid(); b++)
+            {
+                Cell::CPtr cellA = array9x9.cell(a);
+                Cell::CPtr cellB = array9x9.cell(b);
+                common += cellA->commonCandidatesCount(cellB);
+                common += cellA->hasAnyOfCandidates(cellB->candidatesMask());
+                common += cellA->candidatesExactMatch(cellB) ? 1 : 0;
+            }
+    }
+    QVERIFY(common > 0);
+}
+
+void CommonTest::benchmarkDynamicSingles()
+{
+    Field array9x9;
+    Resolver resolver9x9(array9x9, nullptr);
+    resolver9x9.registerTechnique<NakedSingleTechnique>();
+    resolver9x9.registerTechnique<HiddenSingleTechnique>();
+
+    QBENCHMARK {
+        for (int idx = 0; idx < 100; idx++)
+        {
+            QVERIFY(array9x9.readFromPlainTextFile("../puzzle/learningcurve.sdm", idx));
+            resolver9x9.process();
+        }
+    }
+}
+
+void CommonTest::benchmarkFastSingles()
+{
+    Field array9x9;
+    Resolver resolver9x9(array9x9, nullptr);
+    resolver9x9.registerTechnique<FastSinglesTechnique>();
+
+    QBENCHMARK {
+        for (int idx = 0; idx < 100; idx++)
+        {
+            QVERIFY(array9x9.readFromPlainTextFile("../puzzle/learningcurve.sdm", idx));
+            resolver9x9.process();
+        }
+    }
+}
+
+void CommonTest::benchmarkBitboard9x9()
+{
+    QFile inputFile("../puzzle/learningcurve.sdm");
+    QVERIFY(inputFile.open(QFile::ReadOnly));
+    QTextStream stream(&inputFile);
+    QStringList lines;
+    while (!stream.atEnd())
+    {
+        const QString line = stream.readLine().simplified();
+        if (!line.isEmpty() && !line.startsWith('#'))
+            lines.append(line);
+    }
+
+    int solved = 0;
+    QBENCHMARK {
+        solved = 0;
+        quint64 nodes = 0;
+        for (const QString& line: std::as_const(lines))
+        {
+            BitboardSolver bitboard;
+            if (bitboard.parse(line) && bitboard.solve(nodes))
+                solved++;
+        }
+    }
+    QCOMPARE(solved, lines.count());
+}
+
+void CommonTest::benchmarkCountSolutions()
+{
+    QFile inputFile("../puzzle/noponies.sdm");
+    QVERIFY(inputFile.open(QFile::ReadOnly));
+    QTextStream stream(&inputFile);
+    QStringList lines;
+    while (!stream.atEnd())
+    {
+        const QString line = stream.readLine().simplified();
+        if (!line.isEmpty() && !line.startsWith('#'))
+            lines.append(line);
+    }
+
+    int unique = 0;
+    QBENCHMARK {
+        unique = 0;
+        for (const QString& line: std::as_const(lines))
+        {
+            BasicField<3> engine;
+            if (engine.parse(line) && engine.countSolutions().isUnique())
+                unique++;
+        }
+    }
+    QCOMPARE(unique, lines.count());
+}
+
+void CommonTest::benchmarkCellSetUnion()
+{
+    Field array9x9;
+    QVERIFY(array9x9.readFromPlainTextFile("../puzzle/learningcurve.sdm", 0));
+    const CellSet a = array9x9.allCellsVisibleFromCell(array9x9.cell(Coord(1, 1, 9)));
+    const CellSet b = array9x9.allCellsVisibleFromCell(array9x9.cell(Coord(5, 6, 9)));
+
+    int count = 0;
+    QBENCHMARK {
+        count += (a + b).count();
+    }
+    QVERIFY(count > 0);
+}
+
+void CommonTest::benchmarkCellSetDifference()
+{
+    Field array9x9;
+    QVERIFY(array9x9.readFromPlainTextFile("../puzzle/learningcurve.sdm", 0));
+    const CellSet a = array9x9.allCellsVisibleFromCell(array9x9.cell(Coord(1, 1, 9)));
+    const CellSet b = array9x9.allCellsVisibleFromCell(array9x9.cell(Coord(2, 6, 9)));
+
+    int count = 0;
+    QBENCHMARK {
+        count += (a - b).count();
+    }
+    QVERIFY(count > 0);
+}
+
+void CommonTest::benchmarkCellSetIntersection()
+{
+    Field array9x9;
+    QVERIFY(array9x9.readFromPlainTextFile("../puzzle/learningcurve.sdm", 0));
+    const CellSet a = array9x9.allCellsVisibleFromCell(array9x9.cell(Coord(1, 1, 9)));
+    const CellSet b = array9x9.allCellsVisibleFromCell(array9x9.cell(Coord(2, 6, 9)));
+
+    int count = 0;
+    QBENCHMARK {
+        count += (a / b).count();
+    }
+    QVERIFY(count > 0);
+}
+
 QTEST_MAIN(CommonTest)
 
 #include "tests.moc"
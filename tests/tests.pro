@@ -2,7 +2,7 @@ QT       += testlib concurrent
 QT       -= gui
 
 TARGET = unit_tests
-CONFIG   += console c++17
+CONFIG   += console c++20
 CONFIG   -= app_bundle
 
 TEMPLATE = app
@@ -29,7 +29,6 @@ DEFINES += SRCDIR=\\\"$$PWD/\\\"
 LIBS += -L../bin -lsudoku
 
 unix {
-    LIBS += -lgsl -lgslcblas
     QMAKE_LFLAGS += "-Wl,-rpath,\'\$$ORIGIN\'"
 }
 